@@ -12,6 +12,11 @@
 
 // ------------------------------------------------
 
+#include "Kaixo/Utils/ReadWriteLock.hpp"
+#include "Kaixo/Utils/TaskScheduler.hpp"
+
+// ------------------------------------------------
+
 namespace Kaixo::Gui {
 
     // ------------------------------------------------
@@ -47,10 +52,31 @@ namespace Kaixo::Gui {
         // ------------------------------------------------
 
         AudioDisplay(Context c);
+        ~AudioDisplay();
 
         // ------------------------------------------------
 
-        virtual AudioFileImage refreshImage(Point<float> visible, Point<int> size) = 0;
+        /** Render a range of columns of the image. The columns are already cleared,
+            and columns outside the range must be left untouched. Should regularly check
+            whether it was canceled, and stop rendering if so.
+
+            @param image            the image to render into, with the visible range as selection.
+            @param firstColumn      first column to render.
+            @param lastColumn       column after the last column to render.
+            @param canceled         set when the image is no longer needed.
+         */
+        virtual void renderColumns(AudioFileImage& image, int firstColumn, int lastColumn, const std::atomic_bool& canceled) = 0;
+
+        // @returns a fully rendered image of the visible range.
+        AudioFileImage refreshImage(Point<float> visible, Point<int> size, const std::atomic_bool& canceled);
+
+        /** Shift the current image when only the visible range moved at the same scale,
+            and only render the columns that became visible. Falls back to a full refresh
+            when the scale or size changed.
+
+            @returns the image of the visible range.
+         */
+        AudioFileImage scrollImage(Point<float> visible, Point<int> size, const std::atomic_bool& canceled);
 
         // ------------------------------------------------
 
@@ -73,20 +99,34 @@ namespace Kaixo::Gui {
         // ------------------------------------------------
 
     protected:
+        // While zooming, a refresh is left to finish when no image was shown for this long.
+        static constexpr auto MinDisplayInterval = std::chrono::milliseconds(100);
+
+        // ------------------------------------------------
+
         AudioFileImage m_Image{};
         Point<float> m_ZoomMillis{};
-        bool m_Dirty = false;
+        bool m_Dirty = false;     // Content changed, render everything
+        bool m_Scrolled = false;  // Only the visible range changed
         bool m_Resized = false;
         bool m_EnableZoom = true;
-        cxxpool::thread_pool m_RefreshPool{ 1 };
-        std::future<void> m_RefreshFuture{};
+        std::future<bool> m_RefreshFuture{}; // false if the refresh was canceled
+        std::shared_ptr<std::atomic_bool> m_RefreshCanceled{};
+        bool m_RefreshFull = false; // Whether the refresh in progress renders everything
         ReadWriteLock m_ImageLock{};
         std::chrono::steady_clock::time_point m_LastResize = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point m_LastDisplay = std::chrono::steady_clock::now();
+        TaskScheduler::Lane m_RefreshLane{}; // Last, so it's destroyed first
 
         // ------------------------------------------------
         
         Point<float> visibleMillis() const;
 
+        /** Cancel the refresh in progress, and wait for it to stop. Must be called 
+            in the destructor of derived classes, as the refresh renders through them.
+         */
+        void stopRefresh();
+
         // ------------------------------------------------
 
     };
@@ -47,9 +47,12 @@ namespace Kaixo::Gui {
 
     private:
         std::future<void> m_TransformFuture{};
-        std::future<Processing::AnalyzeResult> m_AnalyzeFuture{};
+        std::future<std::shared_ptr<const Processing::AnalyzeResult>> m_AnalyzeFuture{};
+        std::shared_ptr<const Processing::AnalyzeResult> m_StreamedResult{}; // Result that is being analyzed
+        std::shared_ptr<const Processing::AnalyzeResult> m_AnalyzeResult{};  // Last finished result
         std::future<Processing::FileLoadResult> m_LoadFuture{};
         Point<float> m_ZoomMillis{}; // Range of the audio file that it's zoomed in on.
+        float m_PanDirection = 0;    // Sign of the last change of the zoom's center.
         std::atomic_bool m_AnalyzeDirty = false;
         Processing::AnalyzeSettings m_AnalyzeSettings{};
         Processing::FileLoadSettings m_FileLoadSettings{};
@@ -58,11 +61,15 @@ namespace Kaixo::Gui {
         // ------------------------------------------------
 
         void scheduleAnalyze();
+        void receiveAnalyzedBlocks();
 
         // ------------------------------------------------
 
         void updateZoomBounds(bool setZoom = false);
 
+        // @returns the duration of a pixel at the current zoom in milliseconds.
+        float millisPerPixel() const;
+
         // ------------------------------------------------
 
         bool waitingForLoad() const;
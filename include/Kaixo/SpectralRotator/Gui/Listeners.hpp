@@ -29,7 +29,8 @@ namespace Kaixo::Gui {
 
     class AnalyzeResultListener : public virtual Listener {
     public:
-        virtual void updateAnalyzeResult(const Processing::AnalyzeResult& r) = 0;
+        virtual void updateAnalyzeResult(std::shared_ptr<const Processing::AnalyzeResult> r) = 0;
+        virtual void analyzedBlocks(const Processing::AnalyzedBlocks&) {};
     };
 
     // ------------------------------------------------
@@ -29,6 +29,7 @@ namespace Kaixo::Gui {
         std::size_t topHeight = 20;
         std::int64_t minimumSelectionSize = 1;
         bool clampToBuffer = true;
+        std::chrono::milliseconds settleTime{ 300 }; // Unchanged for this long before it's precomputed
 
         // ------------------------------------------------
 
@@ -76,6 +77,10 @@ namespace Kaixo::Gui {
         Point<float> m_Zoom;
         Point<float> m_ZoomDragStart;
 
+        Processing::Selection m_LastSelection{};
+        std::chrono::steady_clock::time_point m_SelectionChanged{};
+        bool m_Settled = true;
+
         // ------------------------------------------------
 
         std::int64_t bufferSize() const;
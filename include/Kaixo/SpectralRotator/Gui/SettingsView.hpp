@@ -22,6 +22,10 @@ namespace Kaixo::Gui {
 
         // ------------------------------------------------
 
+        Processing::InterfaceStorage<Processing::AudioBufferInterface> interface = context.interface<Processing::AudioBufferInterface>();
+
+        // ------------------------------------------------
+
         Processing::FileLoadSettings fileLoadSettings;
         Processing::AnalyzeSettings analyzeSettings;
 
@@ -37,6 +41,7 @@ namespace Kaixo::Gui {
 
         void updateFileLoadSettings();
         void updateAnalyzeSettings();
+        void updatePlaybackSettings();
 
         // ------------------------------------------------
 
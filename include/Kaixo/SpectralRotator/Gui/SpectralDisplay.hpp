@@ -16,7 +16,7 @@ namespace Kaixo::Gui {
     
     // ------------------------------------------------
 
-    class SpectralDisplay : public AudioDisplay, public AnalyzeResultListener {
+    class SpectralDisplay : public AudioDisplay, public AnalyzeResultListener, public SettingsListener {
     public:
 
         // ------------------------------------------------
@@ -30,20 +30,30 @@ namespace Kaixo::Gui {
         // ------------------------------------------------
 
         SpectralDisplay(Context c);
+        ~SpectralDisplay();
 
         // ------------------------------------------------
 
-        void updateAnalyzeResult(const Processing::AnalyzeResult& r) override;
+        void updateAnalyzeResult(std::shared_ptr<const Processing::AnalyzeResult> r) override;
+        void analyzedBlocks(const Processing::AnalyzedBlocks& blocks) override;
+
+        // Only the dynamic range is used, which doesn't require a new analyze result.
+        void updateAnalyzeSettings(const Processing::AnalyzeSettings& v) override;
 
         // ------------------------------------------------
 
-        AudioFileImage refreshImage(Point<float> visible, Point<int> size) override;
+        void renderColumns(AudioFileImage& image, int firstColumn, int lastColumn, const std::atomic_bool& canceled) override;
 
         // ------------------------------------------------
 
     private:
+        static constexpr std::size_t ColorSteps = 256;
+
+        // ------------------------------------------------
+
         mutable std::mutex m_AnalyzeResultMutex{};
-        Processing::AnalyzeResult m_AnalyzeResult{};
+        std::shared_ptr<const Processing::AnalyzeResult> m_AnalyzeResult{};
+        std::atomic<float> m_Range = Processing::AnalyzeSettings{}.fftRange;
 
         // ------------------------------------------------
 
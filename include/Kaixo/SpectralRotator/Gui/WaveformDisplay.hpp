@@ -20,10 +20,11 @@ namespace Kaixo::Gui {
         // ------------------------------------------------
 
         WaveformDisplay(Context c);
+        ~WaveformDisplay();
 
         // ------------------------------------------------
 
-        AudioFileImage refreshImage(Point<float> visible, Point<int> size) override;
+        void renderColumns(AudioFileImage& image, int firstColumn, int lastColumn, const std::atomic_bool& canceled) override;
 
         // ------------------------------------------------
         
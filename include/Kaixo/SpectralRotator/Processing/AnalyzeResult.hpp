@@ -6,6 +6,10 @@
 
 // ------------------------------------------------
 
+#include "Kaixo/SpectralRotator/Processing/SpectrogramTile.hpp"
+
+// ------------------------------------------------
+
 namespace Kaixo::Processing {
 
     // ------------------------------------------------
@@ -13,32 +17,165 @@ namespace Kaixo::Processing {
     struct AnalyzeSettings {
         std::size_t fftSize = 512; // bins
         float fftResolution = 1;   // millis
-        float fftRange = 48;       // decibel
+        float fftRange = 48;       // decibel, only used for displaying
+
+        // @returns true if the analyze result of these settings differs from the other's.
+        bool requiresAnalyze(const AnalyzeSettings& other) const;
     };
 
     // ------------------------------------------------
 
+    // Range of the buffer that needs to be analyzed.
+    struct AnalyzeRange {
+        float start = 0;     // millis
+        float end = 0;       // millis
+        float direction = 0; // Pan direction, more is prefetched in this direction
+        float pixel = 0;     // millis per pixel, 0 analyzes every block
+    };
+
+    // ------------------------------------------------
+
+    /**
+        Spectrogram of a buffer, made up of tiles of TileBlocks blocks. Only the
+        tiles around the analyzed range exist, blocks in any of the other tiles
+        are silent. The result and its tiles are shared immutably, so they never
+        have to be copied. Every tile contains a pyramid of Levels levels, where a
+        block of level L averages Reduction^L analyzed blocks.
+
+        When a pixel spans more than Reduction blocks, only every stride()-th block
+        of the analyze settings is analyzed, so the amount of analyzed blocks, and
+        the memory they keep alive, depends on the size of the view, not of the buffer.
+     */
     class AnalyzeResult {
     public:
 
         // ------------------------------------------------
 
-        struct AnalyzeBlock {
-            std::vector<float> result;
-        };
+        static constexpr std::int64_t TileBlocks = 256;
+        static constexpr std::size_t Reduction = SpectrogramTile::Reduction;
+        static constexpr std::size_t Levels = 5; // Coarsest level has 1 block per tile
+
+        // @returns the amount of analyzed blocks averaged by a single block of the level.
+        static constexpr std::int64_t blocksPerBlock(std::size_t level) {
+            std::int64_t blocks = 1;
+            for (std::size_t i = 0; i < level; ++i) blocks *= Reduction;
+            return blocks;
+        }
 
         // ------------------------------------------------
 
-        AnalyzeSettings settings;
-        std::vector<AnalyzeBlock> blocks;
-        float sampleRate;
+        /** Find the stride at which to analyze, the largest power of Reduction for
+            which the analyzed blocks are still at most the duration of a pixel apart.
+
+            @param settings             the analyze settings.
+            @param pixel                duration of a pixel in milliseconds, 0 for every block.
+
+            @returns the stride in blocks of the analyze settings.
+         */
+        static std::int64_t stride(const AnalyzeSettings& settings, float pixel);
 
         // ------------------------------------------------
 
-        float intensityAt(float millis, float normalizedFrequency);
+        AnalyzeResult() = default;
+        AnalyzeResult(AnalyzeSettings settings, float sampleRate, std::int64_t blocks, std::size_t bins, std::int64_t stride = 1);
 
         // ------------------------------------------------
 
+        AnalyzeSettings settings{};
+        float sampleRate = 0;
+
+        // ------------------------------------------------
+
+        std::int64_t blocks() const;
+        std::size_t bins() const;
+        std::int64_t tiles() const;
+        std::int64_t stride() const;
+
+        // @returns the duration between analyzed blocks in milliseconds.
+        float resolution() const;
+
+        // ------------------------------------------------
+
+        // Set a tile, only while creating the result.
+        void tile(std::int64_t index, std::shared_ptr<const SpectrogramTile> tile);
+
+        // @returns the tile, or nullptr if it doesn't exist in this result.
+        const SpectrogramTile* tile(std::int64_t index) const;
+
+        // ------------------------------------------------
+
+        /** Get the quantized row of a block.
+
+            @param block                index of the block within its level.
+            @param level                level in the pyramid, 0 are the analyzed blocks.
+
+            @returns the row, or nullptr if the block has not been analyzed.
+         */
+        const std::int16_t* block(std::int64_t block, std::size_t level = 0) const;
+
+        /** Find the coarsest level whose blocks are still at most the given duration,
+            so a view never skips over blocks, without reading more of them than needed.
+
+            @param millis               duration of a pixel in milliseconds.
+
+            @returns the level.
+         */
+        std::size_t level(float millis) const;
+
+        /** Check whether a range has been fully analyzed, finely enough for the zoom.
+
+            @param start                start of the range in milliseconds.
+            @param end                  end of the range in milliseconds.
+            @param pixel                duration of a pixel in milliseconds.
+
+            @returns true if all blocks in the range have been analyzed at the stride of the zoom, or finer.
+         */
+        bool covers(float start, float end, float pixel = 0) const;
+
+        // ------------------------------------------------
+
+        /** Get the interpolated decibels at a point in time and frequency.
+
+            @param millis               time in milliseconds.
+            @param normalizedFrequency  frequency, normalized to the nyquist frequency.
+            @param level                level in the pyramid to read from.
+
+            @returns the decibels.
+         */
+        float decibelsAt(float millis, float normalizedFrequency, std::size_t level = 0) const;
+
+        /** Get the interpolated intensity at a point in time and frequency.
+
+            @param millis               time in milliseconds.
+            @param normalizedFrequency  frequency, normalized to the nyquist frequency.
+            @param range                dynamic range in decibels, mapped to [0, 1].
+            @param level                level in the pyramid to read from.
+
+            @returns the intensity.
+         */
+        float intensityAt(float millis, float normalizedFrequency, float range, std::size_t level = 0) const;
+
+        // ------------------------------------------------
+
+    private:
+        std::int64_t m_Blocks = 0;
+        std::size_t m_Bins = 0;
+        std::int64_t m_Stride = 1;
+        std::vector<std::shared_ptr<const SpectrogramTile>> m_Tiles{};
+
+        // ------------------------------------------------
+
+    };
+
+    static_assert(AnalyzeResult::blocksPerBlock(AnalyzeResult::Levels - 1) == AnalyzeResult::TileBlocks, "Tiles must be aligned to the coarsest level");
+
+    // ------------------------------------------------
+
+    // Range of blocks [first, last) that finished analyzing, published while analyzing.
+    struct AnalyzedBlocks {
+        std::shared_ptr<const AnalyzeResult> result{};
+        std::size_t first = 0;
+        std::size_t last = 0;
     };
 
     // ------------------------------------------------
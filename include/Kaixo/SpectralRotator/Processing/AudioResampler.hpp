@@ -7,10 +7,19 @@
 
 // ------------------------------------------------
 
+#include "Kaixo/SpectralRotator/Processing/ResamplerBank.hpp"
+
+// ------------------------------------------------
+
 namespace Kaixo::Processing {
     
     // ------------------------------------------------
     
+    /**
+        Resamples a stream of audio. Blocks are resampled with the polyphase filters
+        of a ResamplerBank. Until the bank for the current rates and quality has been
+        built, it falls back to linear interpolation of anti-aliased input.
+     */
     class AudioResampler {
     public:
 
@@ -19,6 +28,9 @@ namespace Kaixo::Processing {
         static constexpr std::size_t BufferSize      = 32768; // ~170ms @ 192kHz, power of 2!
         static constexpr std::size_t RebaseThreshold = BufferSize;
 
+        // Input samples kept for the polyphase filters, must fit the longest filter.
+        static constexpr std::size_t InputSize = 4 * ResamplerBank::MaxRadius + 2048;
+
         // ------------------------------------------------
 
         struct {
@@ -26,6 +38,47 @@ namespace Kaixo::Processing {
             float out = 48000.0f;
         } sampleRate;
 
+        ResamplerQuality quality = ResamplerQuality::Normal;
+
+        // ------------------------------------------------
+
+        /** Resample a block. Input is read up to the radius of the filter ahead of the output.
+
+            @param output           receives the resampled block.
+            @param read             called with spans it has to fill with the next input samples.
+         */
+        void process(std::span<Stereo> output, auto read) {
+            if (sampleRate.in == sampleRate.out) return read(output);
+
+            if (!updateBank()) {
+                for (auto& sample : output) {
+                    sample = generate([&] {
+                        Stereo input{ 0, 0 };
+                        read(std::span<Stereo>{ &input, 1 });
+                        return input;
+                    });
+                }
+
+                return;
+            }
+
+            while (!output.empty()) {
+                std::size_t count = output.size();
+                const std::size_t needed = reserve(count);
+                if (needed > 0) {
+                    std::span<Stereo> input{ m_Input.data(), needed };
+                    read(input);
+                    append(input);
+                }
+
+                render(output.first(count));
+                output = output.subspan(count);
+            }
+        }
+
+        // @returns false while falling back to interpolation, because the bank isn't built yet.
+        bool ready() const { return sampleRate.in == sampleRate.out || m_Bank != nullptr; }
+
         // ------------------------------------------------
 
         Stereo generate(auto generator) {
@@ -59,6 +112,20 @@ namespace Kaixo::Processing {
         // ------------------------------------------------
 
     private:
+        std::shared_ptr<const ResamplerBank> m_Bank{};
+        float m_BankIn = 0;  // Rates and quality the bank was requested for
+        float m_BankOut = 0;
+        ResamplerQuality m_BankQuality = ResamplerQuality::Normal;
+
+        std::array<Stereo, InputSize> m_Input{}; // Interleaved, as read
+        std::array<float, InputSize> m_Left{};
+        std::array<float, InputSize> m_Right{};
+        std::size_t m_Count = 0; // Samples in m_Left and m_Right
+        std::size_t m_Base = 0;  // First sample used by the current output
+        std::size_t m_Phase = 0; // Phase of the current output
+
+        // ------------------------------------------------
+
         AAFilter m_Filter;
         std::array<Stereo, BufferSize> m_Buffer{};
         std::size_t m_WriteIndex = 0;
@@ -73,10 +140,32 @@ namespace Kaixo::Processing {
 
         // ------------------------------------------------
 
+        // Looks up the bank when the rates or quality changed, @returns true if it's available.
+        bool updateBank();
+
+        // Switch to a bank, continuing from the input the fallback or the current bank already read.
+        void continueFromFallback(const ResamplerBank& bank);
+        void continueFromBank(const ResamplerBank& bank);
+
+        /** Make room for a block, dropping the samples that are no longer needed.
+
+            @param count            amount of outputs, lowered to the amount that fits.
+
+            @returns the amount of input samples that have to be appended.
+         */
+        std::size_t reserve(std::size_t& count);
+
+        void append(std::span<const Stereo> input);
+        void render(std::span<Stereo> output);
+
+        // ------------------------------------------------
+
         void rebasing() {
-            uint32_t i0 = static_cast<uint32_t>(m_InputPos);
+            // Whole buffers, so every sample stays at the same place in the buffer, and never past
+            // the input that was read, which the position can already be when downsampling.
+            const uint64_t i0 = Math::min(static_cast<uint64_t>(m_InputPos), m_InputCount) & ~static_cast<uint64_t>(BufferSize - 1);
             if (i0 < RebaseThreshold) return;
-            
+
             m_InputCount -= i0;
             m_InputPos -= (float)i0;
         }
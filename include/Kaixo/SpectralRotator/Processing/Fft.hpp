@@ -28,11 +28,15 @@
 // ------------------------------------------------
 
 #include <complex>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 // ------------------------------------------------
 
 #include "Kaixo/SpectralRotator/Processing/ProgressCounter.hpp"
+#include "Kaixo/Utils/TaskScheduler.hpp"
 
 // ------------------------------------------------
 
@@ -40,19 +44,337 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
+    struct Fft;
+
+    // ------------------------------------------------
+
+    /**
+        Precomputed trigonometric tables and bit-reversal permutation for a
+        radix-2 FFT of a specific size and direction. The twiddle factors are
+        stored per stage, split into real and imaginary parts, so the butterflies
+        can load them contiguously.
+     */
+    class FftPlan {
+    public:
+
+        // ------------------------------------------------
+
+        FftPlan(std::size_t size, bool inverse);
+
+        // ------------------------------------------------
+
+        std::size_t size() const;
+        bool inverse() const;
+
+        // ------------------------------------------------
+
+        /** Get the twiddle factors of a single stage.
+
+            @param half             half the size of the butterfly groups in the stage.
+
+            @returns pointer to the `half` twiddle factors of the stage.
+         */
+        const float* twiddlesReal(std::size_t half) const;
+        const float* twiddlesImag(std::size_t half) const;
+
+        // ------------------------------------------------
+
+        const std::vector<std::uint32_t>& permutation() const;
+
+        // ------------------------------------------------
+
+    private:
+        std::size_t m_Size;
+        bool m_Inverse;
+        std::vector<float> m_TwiddlesReal{};
+        std::vector<float> m_TwiddlesImag{};
+        std::vector<std::uint32_t> m_Permutation{};
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+    /**
+        Plan for a large radix-2 FFT, decomposed into a matrix of smaller FFTs using
+        the four-step algorithm. A transform of size N = rows * columns is done as
+        'rows' FFTs of size 'columns', a twiddle multiplication, and 'columns' FFTs of
+        size 'rows'. The smaller FFTs are independent, so they can run in parallel,
+        and each of them fits in the cache.
+     */
+    class FourStepPlan {
+    public:
+
+        // ------------------------------------------------
+
+        FourStepPlan(std::size_t size, bool inverse);
+
+        // ------------------------------------------------
+
+        std::size_t size() const;
+        bool inverse() const;
+
+        // ------------------------------------------------
+
+        std::size_t rows() const;
+        std::size_t columns() const;
+
+        // ------------------------------------------------
+
+        // Plan for the FFTs of size 'columns', done first.
+        const FftPlan& rowPlan() const;
+
+        // Plan for the FFTs of size 'rows', done last.
+        const FftPlan& columnPlan() const;
+
+        // ------------------------------------------------
+
+        // @returns the twiddle factor between the 2 passes, exp(+-2pi i * row * column / size).
+        std::complex<float> twiddle(std::size_t row, std::size_t column) const;
+
+        // ------------------------------------------------
+
+    private:
+        std::size_t m_Size;
+        bool m_Inverse;
+        std::size_t m_Rows;
+        std::size_t m_Columns;
+        std::size_t m_ColumnBits;
+        std::vector<std::complex<float>> m_Coarse{};
+        std::vector<std::complex<float>> m_Fine{};
+        std::shared_ptr<const FftPlan> m_RowPlan{};
+        std::shared_ptr<const FftPlan> m_ColumnPlan{};
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+    /**
+        Precomputed chirp and transformed convolution kernel for a Bluestein FFT
+        of a specific size and direction. The kernel spectrum is already scaled,
+        so a transform only takes one forward and one inverse radix-2 FFT.
+     */
+    class BluesteinPlan {
+    public:
+
+        // ------------------------------------------------
+
+        // Entries of the chirp table computed between checks for cancelation.
+        static constexpr std::size_t CancelCheckInterval = 1 << 16;
+
+        // ------------------------------------------------
+
+        /** Create the plan, using the given Fft to transform the kernel, so
+            its progress, cancelation and worker pool are used. A canceled plan is incomplete.
+
+            @param size             the size of the FFT.
+            @param inverse          the direction of the FFT.
+            @param fft              the Fft used to transform the kernel.
+         */
+        BluesteinPlan(std::size_t size, bool inverse, Fft& fft);
+
+        // ------------------------------------------------
+
+        std::size_t size() const;
+        bool inverse() const;
+
+        // ------------------------------------------------
+
+        const std::vector<std::complex<float>>& chirp() const;
+        const std::vector<std::complex<float>>& kernel() const;
+
+        // ------------------------------------------------
+
+    private:
+        std::size_t m_Size;
+        bool m_Inverse;
+        std::vector<std::complex<float>> m_Chirp{};
+        std::vector<std::complex<float>> m_Kernel{};
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+    /**
+        Plan for a forward FFT of real input. The input is packed into a complex
+        FFT of half the size, after which the spectrum is separated using the
+        precomputed post-twiddle factors.
+     */
+    class RealFftPlan {
+    public:
+
+        // ------------------------------------------------
+
+        RealFftPlan(std::size_t size, bool inverse);
+
+        // ------------------------------------------------
+
+        std::size_t size() const;
+
+        // ------------------------------------------------
+
+        const std::vector<std::complex<float>>& twiddles() const;
+
+        // ------------------------------------------------
+
+        const FftPlan& half() const;
+
+        // ------------------------------------------------
+
+    private:
+        std::size_t m_Size;
+        std::vector<std::complex<float>> m_Twiddles{};
+        std::shared_ptr<const FftPlan> m_Half{};
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+    /**
+        Thread-safe cache of FFT plans, so the tables of a plan are only built once
+        for every size and direction. Small power-of-2 plans are kept alive for the
+        lifetime of the program, other plans only while they are being used.
+     */
+    class FftPlanCache {
+    public:
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t MaxRetainedSize = 1 << 16;
+
+        // ------------------------------------------------
+
+        /** Get the plan for a radix-2 FFT, creating it if it doesn't exist yet.
+
+            @param size             the size of the FFT, must be a power of 2.
+            @param inverse          the direction of the FFT.
+
+            @returns the plan.
+         */
+        static std::shared_ptr<const FftPlan> radix2(std::size_t size, bool inverse);
+
+        /** Get the plan for a four-step FFT, creating it if it doesn't exist yet.
+
+            @param size             the size of the FFT, must be a power of 2.
+            @param inverse          the direction of the FFT.
+
+            @returns the plan.
+         */
+        static std::shared_ptr<const FourStepPlan> fourStep(std::size_t size, bool inverse);
+
+        /** Get the plan for a Bluestein FFT, creating it if it doesn't exist yet.
+            Bluestein plans can have any size, so they are never retained, they are
+            only shared while in use. Use Fft::prepare to keep one alive over several
+            transforms. A plan of which the creation got canceled is returned, but not stored.
+
+            @param size             the size of the FFT.
+            @param inverse          the direction of the FFT.
+            @param fft              the Fft used to create the plan.
+
+            @returns the plan.
+         */
+        static std::shared_ptr<const BluesteinPlan> bluestein(std::size_t size, bool inverse, Fft& fft);
+
+        /** Get the plan for a forward real-input FFT, creating it if it doesn't exist yet.
+
+            @param size             the size of the FFT, must be a power of 2, and at least 2.
+
+            @returns the plan.
+         */
+        static std::shared_ptr<const RealFftPlan> real(std::size_t size);
+
+        // ------------------------------------------------
+
+    private:
+        using Key = std::pair<std::size_t, bool>;
+
+        template<class Plan>
+        struct Plans {
+            std::map<Key, std::shared_ptr<const Plan>> retained{};
+            std::map<Key, std::weak_ptr<const Plan>> used{};
+        };
+
+        std::mutex m_Mutex{};
+        Plans<FftPlan> m_Radix2{};
+        Plans<FourStepPlan> m_FourStep{};
+        Plans<BluesteinPlan> m_Bluestein{};
+        Plans<RealFftPlan> m_Real{};
+
+        // ------------------------------------------------
+
+        template<class Plan>
+        std::shared_ptr<const Plan> find(Plans<Plan>& plans, Key key);
+
+        template<class Plan>
+        std::shared_ptr<const Plan> insert(Plans<Plan>& plans, Key key, std::shared_ptr<const Plan> plan, bool retain);
+
+        template<class Plan>
+        std::shared_ptr<const Plan> get(Plans<Plan>& plans, std::size_t size, bool inverse, bool retain);
+
+        // ------------------------------------------------
+
+        static FftPlanCache& instance();
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
     struct Fft {
 
         // ------------------------------------------------
 
+        // Radix-2 FFTs of at least this size use the four-step algorithm when parallel is set.
+        static constexpr std::size_t FourStepSize = 1 << 18;
+
+        // ------------------------------------------------
+
         ProgressCounter* progress = nullptr;
         std::atomic_bool* cancelation = nullptr;
+        bool parallel = false; // Spread large transforms over the shared scheduler
+        TaskPriority priority = TaskPriority::Background; // Of the tasks when parallel
 
         // ------------------------------------------------
 
         void transform(std::vector<std::complex<float>>& vec, bool inverse);
+        void transform(const FftPlan& plan, std::vector<std::complex<float>>& vec);
         void transformRadix2(std::vector<std::complex<float>>& vec, bool inverse);
         void transformBluestein(std::vector<std::complex<float>>& vec, bool inverse);
 
+        /** Four-step FFT, the smaller FFTs are spread over the worker pool, 
+            or done on the calling thread if there is no pool.
+
+            @param plan             the four-step plan.
+            @param vec              the data to transform, size must match the plan.
+         */
+        void transformFourStep(const FourStepPlan& plan, std::vector<std::complex<float>>& vec);
+
+        /** Create the plan for an FFT of the given size ahead of time, so 
+            concurrent transforms of that size don't all create it. The plan is
+            kept alive by this Fft and its copies, and released with the last of them.
+
+            @param size             the size of the FFT.
+            @param inverse          the direction of the FFT.
+         */
+        void prepare(std::size_t size, bool inverse);
+
+        /** Forward FFT of real input. Only the non-negative frequencies are
+            calculated, as the rest of the spectrum is their complex conjugate.
+
+            @param plan             the real FFT plan.
+            @param input            real input, size must match the plan.
+            @param output           receives the size / 2 + 1 frequency bins.
+         */
+        void transformReal(const RealFftPlan& plan, const std::vector<float>& input, std::vector<std::complex<float>>& output);
+
         // ------------------------------------------------
 
         std::vector<std::complex<float>> convolve(
@@ -62,14 +384,22 @@ namespace Kaixo::Processing {
         // ------------------------------------------------
 
         std::size_t estimateSteps(std::size_t size, bool inverse);
+        std::size_t estimateRealSteps(std::size_t size);
 
         // ------------------------------------------------
 
-        void step();
+        void step(std::int64_t amount = 1);
         bool shouldStop();
 
         // ------------------------------------------------
 
+    private:
+        std::vector<float> m_Real{};
+        std::vector<float> m_Imag{};
+        std::shared_ptr<const BluesteinPlan> m_Prepared{};
+
+        // ------------------------------------------------
+
     };
 
     // ------------------------------------------------
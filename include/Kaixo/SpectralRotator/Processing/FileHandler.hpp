@@ -11,8 +11,15 @@
 #include "Kaixo/SpectralRotator/Processing/Fft.hpp"
 #include "Kaixo/SpectralRotator/Processing/FilePlayer.hpp"
 #include "Kaixo/SpectralRotator/Processing/SafeAudioBuffer.hpp"
+#include "Kaixo/SpectralRotator/Processing/PeakPyramid.hpp"
 #include "Kaixo/SpectralRotator/Processing/TransformCache.hpp"
 #include "Kaixo/SpectralRotator/Processing/AnalyzeResult.hpp"
+#include "Kaixo/SpectralRotator/Processing/SpectrogramCache.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/LockFreeQueue.hpp"
+#include "Kaixo/Utils/TaskScheduler.hpp"
 
 // ------------------------------------------------
 
@@ -72,6 +79,12 @@ namespace Kaixo::Processing {
 
         void process() override;
 
+        /** Render a block of the file player, the buffer is only accessed once for the whole block.
+
+            @param block            receives the block.
+         */
+        void processBlock(std::span<Stereo> block);
+
         // ------------------------------------------------
 
         // Clears the current session, clears all the buffers.
@@ -100,15 +113,34 @@ namespace Kaixo::Processing {
          */
         std::future<void> transform(TransformInstruction t);
 
+        /** Speculatively compute the FFT of the current selection at idle priority, so the
+            first rotation doesn't have to wait for it. Replaces the previous speculative job.
+            It runs outside the job queue, so it never holds up a load or transform. Those
+            cancel it, a transform of the same selection uses its result if it finished.
+         */
+        void precompute();
+
         // ------------------------------------------------
 
-        /** Analyze the buffer based on the given parameters.
+        /** Analyze the range of the buffer based on the given parameters. Only the
+            tiles around the range are analyzed, tiles that were analyzed before
+            are taken from the cache. Blocks are published through analyzedBlocks 
+            while analyzing.
             
             @param settings         the analyze settings.
+            @param range            the range to analyze, usually the visible range.
 
             @return the analyze result.
          */
-        std::future<AnalyzeResult> analyze(AnalyzeSettings settings);
+        std::future<std::shared_ptr<const AnalyzeResult>> analyze(AnalyzeSettings settings, AnalyzeRange range);
+
+        /** Get the next range of blocks that finished analyzing. Never blocks.
+
+            @param blocks           receives the range of blocks.
+
+            @returns false if there are no new blocks.
+         */
+        bool analyzedBlocks(AnalyzedBlocks& blocks);
 
         // Request that the analyze stops, to make room for a new one.
         void requestCancelAnalyze();
@@ -132,6 +164,15 @@ namespace Kaixo::Processing {
 
         // ------------------------------------------------
 
+        /** Get the peaks of the buffer, rebuilt every time the buffer changes.
+            Never returns nullptr.
+
+            @returns the peak pyramid.
+         */
+        std::shared_ptr<const PeakPyramid> peaks() const;
+
+        // ------------------------------------------------
+
         // @returns the analyze progress.
         float analyzeProgress() const;
 
@@ -147,14 +188,16 @@ namespace Kaixo::Processing {
         // ------------------------------------------------
 
     private:
-        mutable std::mutex m_Mutex{};
+        mutable std::shared_mutex m_Mutex{}; // Shared by jobs that only read the buffer
+        std::mutex m_SaveMutex{};
+        std::mutex m_AnalyzeMutex{};
         bool m_InSession = false;
         Selection m_CachedSelection{};
 		Transform m_CurrentTransform{ Transform::Identity };
         juce::AudioFormatManager m_FormatManager;
         TransformCache m_Cache{};
+        SpectrogramCache m_Spectrograms{};
         std::atomic_size_t m_StateCounter = 0;
-        cxxpool::thread_pool m_ActivityWorker{ 1 };
         std::atomic_size_t m_TimelineLength = 0;
         std::atomic_int64_t m_IdentityBufferOffset = 0;
         std::filesystem::path m_LoadedFile{};
@@ -163,6 +206,15 @@ namespace Kaixo::Processing {
 
         // ------------------------------------------------
 
+        LockFreeQueue<AnalyzedBlocks, 1024> m_AnalyzedBlocks{};
+
+        // ------------------------------------------------
+
+        mutable std::mutex m_PeaksMutex{};
+        std::shared_ptr<const PeakPyramid> m_Peaks = std::make_shared<PeakPyramid>();
+
+        // ------------------------------------------------
+
         std::atomic_bool m_LoadCanceled = false;
         std::atomic_bool m_AnalyzerCanceled = false;
         std::atomic_bool m_TransformCanceled = false;
@@ -173,27 +225,64 @@ namespace Kaixo::Processing {
 
         // ------------------------------------------------
 
-        /** Perform the given transform operation on the current buffer, and store the result in the cache.
+        std::mutex m_PrecomputeTagMutex{};
+        std::shared_ptr<std::atomic_bool> m_PrecomputeCanceled = std::make_shared<std::atomic_bool>(true);
+        Selection m_PrecomputeSelection{}; // Selection and version the speculative job was pushed for
+        std::size_t m_PrecomputeVersion = 0;
+        std::shared_ptr<const juce::AudioBuffer<float>> m_Precomputed{}; // Finished, until a transform takes it
+        ProgressCounter m_PrecomputeProgress{}; // Not shown, speculative work isn't waited for
+
+        // ------------------------------------------------
+
+        // Loading and transforming write the buffer, saving and analyzing only read it,
+        // so those can run at the same time. Declared last, so they wait for the running
+        // jobs before anything else is destroyed.
+        TaskScheduler::Lane m_PrecomputeLane{};
+        TaskScheduler::ReadWriteLane m_Jobs{};
+
+        // ------------------------------------------------
+
+        /** Perform the given transform operation on a buffer. The operations only map
+            indices and signs, so the buffer isn't copied.
 
 			@param start            the transform to start from, used to add to cache after operation.
             @param ops              the operations to perform, as a bitmask of Operation values.
             @param select           the selection of samples in the buffer.
 			@param buffer           the buffer to perform the transform on.
+
+            @returns the view on the buffer that shows the transformed selection.
          */
-        void performTransform(Transform start, TransformOperation ops, Selection select, const juce::AudioBuffer<float>& buffer);
+        SafeAudioBuffer::View performTransform(Transform start, TransformOperation ops, Selection select, const juce::AudioBuffer<float>& buffer);
 
-        /** Performs a single FFT on the buffer, and saves it to the cache as Transform::Rotate90
+        /** Performs a single FFT on the buffer, giving Transform::Mirror90.
 
             @param select           the selection of samples in the buffer.
 			@param buffer           the buffer to perform the transform on.
+            @param priority         priority of the parallel tasks.
+            @param progress         progress counter of the FFT.
+            @param cancelled        stops the FFT when set.
+
+            @returns the transformed selection, or nullptr when canceled.
          */
-        void performFft(Selection select, const juce::AudioBuffer<float>& buffer);
+        std::shared_ptr<const juce::AudioBuffer<float>> performFft(Selection select, const juce::AudioBuffer<float>& buffer, 
+            TaskPriority priority, ProgressCounter& progress, std::atomic_bool& cancelled);
 
-        // Normalizes the current buffer.
-        void performNormalize(ProgressCounter& progress, std::atomic_bool& cancelled);
+        // Normalizes a view on a buffer with its gain, before it's published.
+        void performNormalize(SafeAudioBuffer::View& view, const juce::AudioBuffer<float>& source, ProgressCounter& progress, std::atomic_bool& cancelled);
 
         // ------------------------------------------------
 
+        // Cancels the speculative job, a result it already finished is kept. @returns true if it hadn't finished.
+        bool cancelPrecompute();
+
+        // @returns the finished speculative FFT of the selection, if it's for the current buffer.
+        std::shared_ptr<const juce::AudioBuffer<float>> takePrecomputed(Selection select);
+
+        // ------------------------------------------------
+
+        // Rebuild the peak pyramid from the current buffer.
+        void updatePeaks();
+
         void notifyStateChanged();
 
         // ------------------------------------------------
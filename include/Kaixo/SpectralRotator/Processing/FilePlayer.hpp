@@ -33,6 +33,13 @@ namespace Kaixo::Processing {
 
         void process() override;
 
+        /** Render a block. Takes a single snapshot of the file for the whole block,
+            so the sample rate and playback position are only read once.
+
+            @param block            receives the block.
+         */
+        void processBlock(std::span<Stereo> block);
+
         // ------------------------------------------------
 
         void togglePlay();
@@ -42,13 +49,26 @@ namespace Kaixo::Processing {
         std::int64_t playhead() const;
         bool playing() const;
 
+        void quality(ResamplerQuality quality);
+        ResamplerQuality quality() const;
+
+        // Request the resampling filters the audio thread is missing, not realtime safe.
+        void prepareResampler();
+
         // ------------------------------------------------
 
     private:
         SafeAudioBuffer& m_File;
         std::atomic_bool m_Playing{ false };
         std::atomic_int64_t m_PlaybackPosition{ 0 };
+        std::atomic<ResamplerQuality> m_Quality{ ResamplerQuality::Normal };
+        std::atomic<float> m_MissingIn{ 0 };  // Rates of the bank the audio thread is missing
+        std::atomic<float> m_MissingOut{ 0 };
+        std::atomic_bool m_BankMissing{ false };
         AudioResampler m_Resampler{};
+
+        // ------------------------------------------------
+
     };
 
     // ------------------------------------------------
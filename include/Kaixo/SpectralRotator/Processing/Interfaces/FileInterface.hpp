@@ -9,6 +9,7 @@
 #include "Kaixo/SpectralRotator/Controller.hpp"
 #include "Kaixo/SpectralRotator/Processing/TransformCache.hpp"
 #include "Kaixo/SpectralRotator/Processing/SafeAudioBuffer.hpp"
+#include "Kaixo/SpectralRotator/Processing/PeakPyramid.hpp"
 #include "Kaixo/SpectralRotator/Processing/FileHandler.hpp"
 
 // ------------------------------------------------
@@ -37,6 +38,9 @@ namespace Kaixo::Processing {
         // set the play position, in samples.
         void playhead(std::int64_t i);
 
+        // set the quality of the resampling filters used for playback.
+        void quality(ResamplerQuality quality);
+
         // ------------------------------------------------
 
         /** Get the audio buffer.
@@ -45,6 +49,12 @@ namespace Kaixo::Processing {
          */
         const SafeAudioBuffer& buffer();
 
+        /** Get the peaks of the audio buffer, updated after the buffer changes.
+        
+            @returns the peak pyramid of the audio buffer.
+         */
+        std::shared_ptr<const PeakPyramid> peaks();
+
         /** Get the timeline length in samples, basically the longest buffer in the session.
             
             @returns the timeline length in samples.
@@ -75,6 +85,9 @@ namespace Kaixo::Processing {
          */
         std::future<void> transform(TransformInstruction instr);
 
+        // Speculatively compute the rotation of the current selection, ahead of the first rotate.
+        void precompute();
+
         /** Used to signal progress of the transform activity.
 
             @returns the progress of the transform activity.
@@ -98,10 +111,19 @@ namespace Kaixo::Processing {
         /** Queue an analyze activity.
             
             @param settings             analyze settings.
+            @param range                range to analyze, usually the visible range.
 
             @returns the analyze result.
          */
-        std::future<AnalyzeResult> analyze(AnalyzeSettings settings);
+        std::future<std::shared_ptr<const AnalyzeResult>> analyze(AnalyzeSettings settings, AnalyzeRange range);
+
+        /** Get the next range of blocks that finished analyzing, while analyzing.
+
+            @param blocks               receives the range of blocks.
+
+            @returns false if there are no new blocks.
+         */
+        bool analyzedBlocks(AnalyzedBlocks& blocks);
 
         /** Used to signal progress of the analyze activity.
 
@@ -0,0 +1,81 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/SafeAudioBuffer.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    /**
+        Minimum and maximum of the buffer, mixed down to mono, per 2^k samples
+        for every level k, starting at 2^BaseLevel samples. Finding the peaks of
+        any range only combines a few blocks per level, so drawing the envelope
+        of a waveform doesn't depend on the amount of samples. Built once for a
+        buffer, and shared immutably after that.
+     */
+    class PeakPyramid {
+    public:
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t BaseLevel = 4;
+        static constexpr std::int64_t BaseSize = 1ll << BaseLevel; // Samples per block of the first level
+
+        // ------------------------------------------------
+
+        struct Peak {
+            float min = 0;
+            float max = 0;
+
+            Peak combine(const Peak& other) const { return { Math::min(min, other.min), Math::max(max, other.max) }; }
+        };
+
+        // ------------------------------------------------
+
+        PeakPyramid() = default;
+
+        /** Build the pyramid of a buffer, the first level is built on the shared scheduler.
+
+            @param buffer           the buffer.
+         */
+        PeakPyramid(const SafeAudioBuffer::ReadBuffer& buffer);
+
+        // ------------------------------------------------
+
+        /** Get the peaks of a range of samples. The range is extended to whole blocks
+            of the first level, so it may include up to BaseSize samples on each side.
+
+            @param start            first sample on the timeline.
+            @param end              sample after the last sample on the timeline.
+
+            @returns the peaks, silence if the range is outside the buffer.
+         */
+        Peak peak(std::int64_t start, std::int64_t end) const;
+
+        // @returns the amount of samples in the buffer the pyramid was built from.
+        std::int64_t size() const;
+
+        // ------------------------------------------------
+
+    private:
+        std::int64_t m_Size = 0;
+        std::int64_t m_StartOffset = 0;
+        std::vector<std::vector<Peak>> m_Levels{}; // Level i holds a peak per 2^(BaseLevel + i) samples
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
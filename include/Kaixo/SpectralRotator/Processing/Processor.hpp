@@ -15,12 +15,13 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
-    class SpectralRotatorProcessor : public Processor {
+    class SpectralRotatorProcessor : public Processor, private juce::Timer {
     public:
 
         // ------------------------------------------------
 
         SpectralRotatorProcessor();
+        ~SpectralRotatorProcessor();
 
         // ------------------------------------------------
 
@@ -32,6 +33,21 @@ namespace Kaixo::Processing {
         
         // ------------------------------------------------
 
+    private:
+        // The host block is rendered in blocks of at most this size.
+        static constexpr std::size_t BlockSize = 256;
+
+        // ------------------------------------------------
+
+        std::array<Stereo, BlockSize> m_Block{};
+
+        // ------------------------------------------------
+
+        // Requests the resampling filters playback is missing, also while the editor is closed.
+        void timerCallback() override;
+
+        // ------------------------------------------------
+
     };
 
     // ------------------------------------------------
@@ -41,6 +41,7 @@ namespace Kaixo::Processing {
         void reset();
         void increaseEstimate(std::int64_t v);
         void step();
+        void step(std::int64_t amount);
         void done();
 
         // ------------------------------------------------
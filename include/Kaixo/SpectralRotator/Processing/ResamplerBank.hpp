@@ -0,0 +1,115 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    enum class ResamplerQuality {
+        Draft = 0,  // Short filter with a wide transition band, cheapest
+        Normal = 1,
+        High = 2,   // Long filter with a steep cutoff
+    };
+
+    // ------------------------------------------------
+
+    /**
+        Polyphase bank of Blackman windowed sinc filters for resampling from one
+        sample rate to another. When the rates have a small common ratio, like
+        44.1 and 48 kHz, there is a phase for every distinct output position, so
+        the output is exact. Otherwise the ratio is approximated with MaxPhases
+        phases. When downsampling, the cutoff is lowered to below the output's
+        Nyquist frequency, and the filter is made longer to keep its steepness.
+        Every phase is normalized, and padded with zeros to a multiple of the
+        vector width.
+     */
+    class ResamplerBank {
+    public:
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t MaxPhases = 4096;
+        static constexpr std::size_t MaxRadius = 256; // Limits the filter length when downsampling by a large ratio
+
+        // ------------------------------------------------
+
+        /** Get a bank without ever blocking or allocating, so it can be used on the
+            audio thread. A bank that doesn't exist yet has to be requested from
+            another thread, nullptr is returned until it's built.
+
+            @param in               input sample rate.
+            @param out              output sample rate.
+            @param quality          quality of the filters.
+
+            @returns the bank, or nullptr if it's not available yet.
+         */
+        static std::shared_ptr<const ResamplerBank> find(float in, float out, ResamplerQuality quality);
+
+        /** Build a bank on the shared scheduler if it doesn't exist yet, and isn't
+            being built already. Playback waits for it, so it's built at audio priority. 
+            Not realtime safe.
+
+            @param in               input sample rate.
+            @param out              output sample rate.
+            @param quality          quality of the filters.
+         */
+        static void request(float in, float out, ResamplerQuality quality);
+
+        /** Build a bank if it doesn't exist yet, and wait for it. Used to have
+            the bank ready before the audio thread needs it.
+
+            @param in               input sample rate.
+            @param out              output sample rate.
+            @param quality          quality of the filters.
+         */
+        static void prepare(float in, float out, ResamplerQuality quality);
+
+        // ------------------------------------------------
+
+        ResamplerBank(float in, float out, ResamplerQuality quality);
+
+        // ------------------------------------------------
+
+        // @returns the amount of phases.
+        std::size_t phases() const { return m_Phases; }
+
+        // @returns the amount of phases the position moves per output sample.
+        std::size_t step() const { return m_Step; }
+
+        // @returns the amount of coefficients per phase, a multiple of 4.
+        std::size_t taps() const { return m_Taps; }
+
+        // @returns the amount of input samples before the output position used by every phase.
+        std::size_t history() const { return m_Radius - 1; }
+
+        /** Get the coefficients of a phase.
+
+            @param phase            the phase, in [0, phases()).
+
+            @returns taps() coefficients, for the input samples at [-history(), taps() - history()).
+         */
+        const float* coefficients(std::size_t phase) const { return m_Coefficients.data() + phase * m_Taps; }
+
+        // ------------------------------------------------
+
+    private:
+        std::size_t m_Phases = 1;
+        std::size_t m_Step = 1;
+        std::size_t m_Radius = 1;
+        std::size_t m_Taps = 4;
+        std::vector<float> m_Coefficients{};
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
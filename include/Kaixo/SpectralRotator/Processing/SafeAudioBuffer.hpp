@@ -3,7 +3,6 @@
 // ------------------------------------------------
 
 #include "Kaixo/Core/Definitions.hpp"
-#include "Kaixo/Utils/ReadWriteLock.hpp"
 
 // ------------------------------------------------
 
@@ -12,42 +11,114 @@ namespace Kaixo::Processing {
     // ------------------------------------------------
 
     /**
-        Wrapper around a juce audio buffer that safely allows read/write.
+        Wrapper around a juce audio buffer that safely allows read/write. The state of
+        the buffer is published as immutable snapshots, a change publishes a new snapshot
+        that readers switch to the next time they read. Readers never block or wait
+        for a writer, so the audio thread can always read. Replaced snapshots are freed
+        by the writing thread once no reader is using them anymore. A snapshot is a view
+        on a shared source buffer, so reversing, flipping and scaling a buffer doesn't
+        copy it, the view is applied while reading.
      */
     class SafeAudioBuffer {
     public:
 
         // ------------------------------------------------
 
+        using Buffer = juce::AudioBuffer<float>;
+
+        // ------------------------------------------------
+
+        /**
+            Maps the samples of a source buffer. The view shows the source samples
+            in [offset, offset + size), backwards when reversed. Samples outside
+            the source are silent.
+         */
+        struct View {
+            std::int64_t offset = 0;
+            std::int64_t size = 0;
+            bool reverse = false;
+            bool flip = false; // Negates every other sample, ring modulating with Nyquist flips the spectrum
+            float gain = 1;
+
+            // @returns a view of a whole buffer, unchanged.
+            static View whole(const Buffer& buffer);
+
+            // @returns true if the view shows the whole buffer unchanged.
+            bool isWhole(const Buffer& buffer) const;
+        };
+
+        // ------------------------------------------------
+
+        // Never changes once published.
+        struct Snapshot {
+            std::shared_ptr<const Buffer> source{}; // Shared with the transform cache
+            View view{};
+            float sampleRate = 44100.0f;
+            std::int64_t startOffset = 0; // Index of the first sample of the view
+            std::size_t version = 0;      // Incremented on every publish
+
+            /** Get the samples of the view as a buffer. Only copies when the
+                view is not the whole source unchanged.
+
+                @returns the buffer.
+             */
+            std::shared_ptr<const Buffer> materialize() const;
+        };
+
+        // ------------------------------------------------
+
         class ReadBuffer {
         public:
 
             // ------------------------------------------------
 
             ReadBuffer(const juce::AudioBuffer<float>& bfr, float sampleRate, std::int64_t startOffset);
+            ReadBuffer(const juce::AudioBuffer<float>& bfr, const View& view, float sampleRate, std::int64_t startOffset);
+            ReadBuffer(const Snapshot& snapshot);
 
             // ------------------------------------------------
 
             Stereo operator[](std::int64_t index) const;
 
+            // ------------------------------------------------
+
+            /** Read a contiguous range of samples, mixed down to mono. Samples
+                outside the buffer are silent.
+
+                @param start                index of the first sample.
+                @param output               receives output.size() samples.
+             */
+            void readMono(std::int64_t start, std::span<float> output) const;
+
+            /** Read a contiguous range of samples. Samples outside the buffer are silent.
+
+                @param start                index of the first sample.
+                @param output               receives output.size() samples.
+             */
+            void read(std::int64_t start, std::span<Stereo> output) const;
+
             // ------------------------------------------------
             
-            /** Get the size of the buffer in samples. Returns 0 if currently writing.
+            /** Get the size of the buffer in samples, including the start offset.
         
                 @returns the size of the buffer.
              */
             std::size_t size() const;
 
-            /** Get the sample rate of the buffer. Returns 0 if currently writing.
+            /** Get the sample rate of the buffer.
             
                 @returns the sample rate of the buffer.
              */
             float sampleRate() const;
 
+            // @returns the index of the first sample of the buffer.
+            std::int64_t startOffset() const;
+
             // ------------------------------------------------
 
         private:
             const juce::AudioBuffer<float>& m_Buffer;
+            View m_View;
             float m_SampleRate;
             std::int64_t m_StartOffset;
 
@@ -57,41 +128,114 @@ namespace Kaixo::Processing {
 
         // ------------------------------------------------
 
-        using Buffer = juce::AudioBuffer<float>;
-        using Callback = std::function<void(Buffer& buffer, float& sampleRate, std::int64_t& startOffset)>;
+    private:
+        struct Node {
+            Snapshot snapshot{};
+            std::atomic_size_t readers = 0;
+        };
+
+        // ------------------------------------------------
+
+    public:
+
+        // ------------------------------------------------
+
+        /**
+            Keeps a snapshot alive while it's being read. Taking and releasing
+            one never blocks and never frees memory.
+         */
+        class Reader {
+        public:
+
+            // ------------------------------------------------
+
+            Reader(const SafeAudioBuffer& buffer);
+            Reader(Reader&& other) noexcept;
+            ~Reader();
+
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+            Reader& operator=(Reader&&) = delete;
+
+            // ------------------------------------------------
+
+            const Snapshot& operator*() const { return m_Node->snapshot; }
+            const Snapshot* operator->() const { return &m_Node->snapshot; }
+
+            // @returns a read buffer of the snapshot.
+            ReadBuffer read() const { return m_Node->snapshot; }
+
+            // ------------------------------------------------
+
+        private:
+            Node* m_Node;
+        };
+
+        // ------------------------------------------------
+
         using ConstCallback = std::function<void(ReadBuffer buffer)>;
 
         // ------------------------------------------------
 
-        /** Access the buffer for writing, from a callback.
+        SafeAudioBuffer();
+        ~SafeAudioBuffer();
+
+        SafeAudioBuffer(const SafeAudioBuffer&) = delete;
+        SafeAudioBuffer& operator=(const SafeAudioBuffer&) = delete;
+
+        // ------------------------------------------------
+
+        /** Publish a new state of the buffer, and free the snapshots that
+            are no longer being read.
             
-            @param callback             callback that will be given the buffer for writing.
+            @param buffer               the new buffer.
+            @param sampleRate           sample rate of the new buffer.
+            @param startOffset          index of the first sample of the new buffer.
          */
-        void access(Callback callback);
+        void publish(Buffer buffer, float sampleRate, std::int64_t startOffset);
+
+        /** Publish a view on a source buffer as the new state of the buffer, and
+            free the snapshots that are no longer being read.
+            
+            @param source               the source buffer, shared without copying.
+            @param view                 the view on the source.
+            @param sampleRate           sample rate of the source.
+            @param startOffset          index of the first sample of the view.
+         */
+        void publish(std::shared_ptr<const Buffer> source, View view, float sampleRate, std::int64_t startOffset);
+
+        // @returns the current snapshot, kept alive as long as the reader exists.
+        Reader snapshot() const;
 
         /** Access the buffer for reading, from a callback.
             
-            @param callback             callback that will be given the buffer for writing.
+            @param callback             callback that will be given the current snapshot.
          */
         void access(ConstCallback callback) const;
 
         // ------------------------------------------------
         
-        /** Get the size of the buffer in samples. Returns 0 if currently writing.
+        /** Get the size of the buffer in samples, including the start offset.
         
             @returns the size of the buffer.
          */
         std::size_t size() const;
 
-        /** Get the sample rate of the buffer. Returns 0 if currently writing.
+        /** Get the sample rate of the buffer.
             
             @returns the sample rate of the buffer.
          */
         float sampleRate() const;
 
+        // @returns the index of the first sample of the buffer.
+        std::int64_t startOffset() const;
+
+        // @returns the version of the current snapshot.
+        std::size_t version() const;
+
         // ------------------------------------------------
 
-        /** Read the sample at index. Handles bounds checking. Results in silence if currently writing.
+        /** Read the sample at index. Handles bounds checking.
 
             @param index                index in the buffer.
 
@@ -99,17 +243,38 @@ namespace Kaixo::Processing {
          */
         Stereo read(std::int64_t index) const;
 
-        // ------------------------------------------------
+        /** Read a contiguous range of samples mixed down to mono, all from the 
+            same snapshot. Samples outside the buffer are silent.
+
+            @param start                index of the first sample.
+            @param output               receives output.size() samples.
+         */
+        void readMono(std::int64_t start, std::span<float> output) const;
+
+        /** Read a contiguous range of samples, all from the same snapshot.
+            Samples outside the buffer are silent.
 
-        // Used to offset the buffer while reading.
-        std::atomic_int64_t startOffset = 0;
+            @param start                index of the first sample.
+            @param output               receives output.size() samples.
+         */
+        void read(std::int64_t start, std::span<Stereo> output) const;
 
         // ------------------------------------------------
 
     private:
-        juce::AudioBuffer<float> m_Buffer{};
-        float m_SampleRate = 44100.0f;
-        ReadWriteLock m_Lock{};
+        std::atomic<Node*> m_Current;
+        mutable std::atomic_size_t m_Acquiring = 0; // Readers between loading m_Current and registering on it
+        std::mutex m_PublishMutex{};
+        std::vector<std::unique_ptr<Node>> m_Retired{}; // Replaced, but maybe still being read
+        std::size_t m_Version = 0;
+
+        // ------------------------------------------------
+
+        // Frees the retired snapshots that are no longer being read, requires m_PublishMutex.
+        void reclaim();
+
+        // ------------------------------------------------
+
     };
 
     // ------------------------------------------------
@@ -0,0 +1,79 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    // @returns the normalized sinc, sin(pi x) / (pi x).
+    double sinc(double x);
+
+    // @returns the Blackman window at x, in [-pi, pi].
+    double blackman(double x);
+
+    // ------------------------------------------------
+
+    /**
+        Polyphase table of Blackman windowed sinc coefficients, for interpolating
+        between samples at a fractional position. Every phase is normalized, and 
+        padded with zeros to a multiple of the vector width, so interpolating is
+        a single dot product.
+     */
+    class SincTable {
+    public:
+
+        // ------------------------------------------------
+
+        static constexpr std::int64_t Radius = 16;
+        static constexpr std::size_t Taps = 2 * Radius + 1;
+        static constexpr std::size_t PaddedTaps = (Taps + 3) / 4 * 4;
+        static constexpr std::size_t Phases = 512; // Resolution of the fractional position
+
+        // ------------------------------------------------
+
+        // @returns the shared table, created on first use.
+        static const SincTable& instance();
+
+        // ------------------------------------------------
+
+        /** Get the coefficients for the phase closest to a fractional position.
+
+            @param fraction         position between 2 samples, in [0, 1].
+
+            @returns PaddedTaps coefficients, for the samples at [-Radius, Radius + 3].
+         */
+        const float* coefficients(float fraction) const;
+
+        /** Interpolate at a fractional position after a sample, linearly
+            interpolating the coefficients of the 2 closest phases.
+
+            @param samples          PaddedTaps samples, starting Radius samples before the sample.
+            @param fraction         position between the sample and the next, in [0, 1].
+
+            @returns the interpolated value.
+         */
+        float interpolate(const float* samples, float fraction) const;
+
+        // ------------------------------------------------
+
+    private:
+        std::vector<float> m_Coefficients{}; // Phases + 1 rows of PaddedTaps coefficients
+
+        // ------------------------------------------------
+
+        SincTable();
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
@@ -0,0 +1,92 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/SpectrogramTile.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    /**
+        Caches the analyzed tiles of the spectrogram, so panning back and forth, or
+        switching back to previous analyze settings, doesn't redo any work. Least 
+        recently used tiles are evicted once the cache grows beyond its memory budget,
+        except for tiles that are still used by an analyze result. Those only cover
+        the view, at a stride of at most a few blocks per pixel. Not thread-safe.
+     */
+    class SpectrogramCache {
+    public:
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t DefaultBudget = 512ull * 1024 * 1024; // bytes
+
+        // ------------------------------------------------
+
+        struct Key {
+            std::size_t fftSize;
+            float fftResolution;
+            std::int64_t tile;
+
+            auto operator<=>(const Key&) const = default;
+        };
+
+        // ------------------------------------------------
+
+        // Clears the cache if the buffer changed since the tiles were analyzed.
+        void invalidate(std::size_t version);
+
+        // Set the memory budget in bytes, evicting tiles if needed.
+        void budget(std::size_t bytes);
+
+        // @returns the amount of memory used by the cached tiles.
+        std::size_t bytes() const;
+
+        // ------------------------------------------------
+
+        /** Get a tile, creating it if it isn't cached yet. A new tile has
+            none of its blocks analyzed.
+
+            @param key              the key of the tile.
+            @param firstBlock       index of the first block of the tile.
+            @param blocks           amount of blocks in the tile.
+            @param bins             amount of frequency bins per block.
+            @param levels           amount of levels in the pyramid of the tile.
+
+            @returns the tile.
+         */
+        std::shared_ptr<SpectrogramTile> tile(Key key, std::int64_t firstBlock, std::size_t blocks, std::size_t bins, std::size_t levels);
+
+        // Evict least recently used tiles until within budget, tiles that are still in use are skipped.
+        void evict();
+
+        // ------------------------------------------------
+
+    private:
+        struct Entry {
+            Key key;
+            std::shared_ptr<SpectrogramTile> tile;
+        };
+
+        std::list<Entry> m_Entries{}; // Most recently used first
+        std::map<Key, std::list<Entry>::iterator> m_Index{};
+        std::size_t m_Bytes = 0;
+        std::size_t m_Budget = DefaultBudget;
+        std::size_t m_Version = 0;
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
@@ -0,0 +1,131 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    /**
+        A range of consecutive blocks of a spectrogram, stored as a single
+        contiguous block of memory, one cache-aligned row of frequency bins
+        per block. Decibels are quantized to 16 bits, in steps of 1/128 dB.
+        Blocks are marked as analyzed once their row is written, only those
+        blocks may be read, so a tile can be shown while it's being analyzed.
+
+        Besides the analyzed blocks (level 0), a tile contains a pyramid of
+        coarser levels, every level averaging Reduction blocks of the level
+        below it, so a zoomed out view doesn't have to read every block.
+     */
+    class SpectrogramTile {
+    public:
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t Alignment = 64; // bytes
+        static constexpr float StepsPerDecibel = 128;
+        static constexpr float MinDecibels = -145;
+        static constexpr float MaxDecibels = 255;
+
+        static constexpr std::size_t Reduction = 4; // Blocks per block of the next level
+
+        // ------------------------------------------------
+
+        /** Allocate a tile, none of its blocks are analyzed yet.
+
+            @param firstBlock           index of the first block of the tile in the whole spectrogram.
+            @param blocks               amount of blocks in the tile.
+            @param bins                 amount of frequency bins per block.
+            @param levels               amount of levels in the pyramid, including the analyzed blocks.
+         */
+        SpectrogramTile(std::int64_t firstBlock, std::size_t blocks, std::size_t bins, std::size_t levels = 1);
+
+        // ------------------------------------------------
+
+        std::int64_t firstBlock() const;
+        std::size_t blocks(std::size_t level = 0) const;
+        std::size_t bins() const;
+        std::size_t levels() const;
+
+        // @returns the amount of memory used by the tile.
+        std::size_t bytes() const;
+
+        // ------------------------------------------------
+
+        /** Get the quantized row of a single block, each row is aligned.
+
+            @param block                index of the block within the tile.
+            @param level                level in the pyramid, 0 are the analyzed blocks.
+
+            @returns pointer to the bins() values of the block.
+         */
+        std::int16_t* block(std::size_t block, std::size_t level = 0);
+        const std::int16_t* block(std::size_t block, std::size_t level = 0) const;
+
+        // ------------------------------------------------
+
+        // @returns true if the row of the block has been written.
+        bool analyzed(std::size_t block, std::size_t level = 0) const;
+
+        // @returns true if all blocks have been analyzed.
+        bool complete() const;
+
+        /** Mark the blocks in [first, last) as analyzed, after their rows have been
+            written. Blocks of coarser levels are computed as soon as all the blocks
+            they average are analyzed, by whichever thread analyzed the last of them.
+
+            @param first                first block within the tile.
+            @param last                 block after the last block within the tile.
+         */
+        void markAnalyzed(std::size_t first, std::size_t last);
+
+        // ------------------------------------------------
+
+        static std::int16_t quantize(float decibels);
+        static float dequantize(std::int16_t value);
+
+        // ------------------------------------------------
+
+    private:
+        struct AlignedDelete {
+            void operator()(std::int16_t* ptr) const;
+        };
+
+        struct Level {
+            std::size_t blocks = 0;
+            std::size_t firstRow = 0;
+            std::unique_ptr<std::atomic_bool[]> analyzed{};
+            std::unique_ptr<std::atomic_uint8_t[]> children{}; // Analyzed blocks of the level below
+        };
+
+        // ------------------------------------------------
+
+        std::int64_t m_FirstBlock = 0;
+        std::size_t m_Bins = 0;
+        std::size_t m_Stride = 0; // Values per row, rows are padded to the alignment
+        std::size_t m_Rows = 0;   // Rows of all levels combined
+        std::unique_ptr<std::int16_t[], AlignedDelete> m_Data{};
+        std::vector<Level> m_Levels{};
+        std::atomic_size_t m_AnalyzedCount = 0;
+
+        // ------------------------------------------------
+
+        // Mark a single block as analyzed, and reduce it into the next level when it completes a block there.
+        void markBlock(std::size_t block, std::size_t level);
+
+        // Average the blocks of the level below into the block.
+        void reduce(std::size_t block, std::size_t level);
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
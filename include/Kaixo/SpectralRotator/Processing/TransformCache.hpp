@@ -6,6 +6,10 @@
 
 // ------------------------------------------------
 
+#include "Kaixo/Utils/TaskScheduler.hpp"
+
+// ------------------------------------------------
+
 namespace Kaixo::Processing {
 
     // ------------------------------------------------
@@ -49,10 +53,22 @@ namespace Kaixo::Processing {
     // ------------------------------------------------
 
     /** 
-        Caches transforms of the original buffer, so as to not redo heavy work.
+        Caches transforms of the original buffer, so as to not redo heavy work. The
+        buffers are shared, so the published buffer can be a view on a cached buffer.
+        The buffers kept in memory are limited to a budget. When it's exceeded, the
+        entries that the published buffer doesn't view are written to a temporary file
+        in the background, after which the entry becomes a view on a memory mapping of
+        the file, which doesn't count towards the budget. A spilled entry is read back
+        into memory when it's used again, so a published buffer never reads from disk 
+        on the audio thread. Thread-safe.
      */
     class TransformCache {
     public:
+        using Buffer = juce::AudioBuffer<float>;
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t DefaultBudget = 512ull * 1024 * 1024;
 
         // ------------------------------------------------
 
@@ -64,20 +80,35 @@ namespace Kaixo::Processing {
 
         // ------------------------------------------------
 
+        /** Set the amount of bytes the cache keeps in memory, entries over it are spilled.
+
+            @param bytes            the budget in bytes.
+         */
+        void budget(std::size_t bytes);
+
+        // @returns the amount of bytes the cache keeps in memory.
+        std::size_t budget() const;
+
+        // @returns the amount of bytes of the buffers in memory.
+        std::size_t bytes() const;
+
+        // ------------------------------------------------
+
         /** Store a transformed buffer in the cache.
         * 
             @param t                the transform that was applied to get this buffer.
 			@param buffer           the transformed buffer to store.
          */
-        void store(Transform t, const juce::AudioBuffer<float>& buffer);
+        void store(Transform t, std::shared_ptr<const Buffer> buffer);
 
-        /** Get a transformed buffer from the cache.
+        /** Get a transformed buffer from the cache. A spilled buffer is read back into memory 
+            first, which can take a while, and counts towards the budget again.
         
             @param t                the transform to get the buffer for.
 
 			@returns the cached buffer for the given transform. Throws if not found.
          */
-        const juce::AudioBuffer<float>& get(Transform t) const;
+        std::shared_ptr<const Buffer> get(Transform t);
 
         /** Check if a transformed buffer is in the cache.
         
@@ -90,7 +121,74 @@ namespace Kaixo::Processing {
         // ------------------------------------------------
 
     private:
-        std::map<Transform, juce::AudioBuffer<float>> m_Cache{};
+
+        /**
+            Buffer written to a temporary file, the file is deleted with it.
+         */
+        class Spill {
+        public:
+
+            // ------------------------------------------------
+
+            /** Write a buffer to a new temporary file.
+
+                @param buffer           the buffer.
+
+                @returns the spill, or nullptr if writing failed.
+             */
+            static std::unique_ptr<Spill> write(const Buffer& buffer);
+
+            /** Map the file of a spill into memory. The mapping owns the spill, so
+                the file is deleted once the buffer isn't used anymore.
+
+                @param spill            the spill.
+
+                @returns the buffer that views the mapped file, or nullptr if mapping failed.
+             */
+            static std::shared_ptr<const Buffer> map(std::unique_ptr<Spill> spill);
+
+            // ------------------------------------------------
+
+            Spill(juce::File file, int channels, int samples);
+            ~Spill();
+
+            // ------------------------------------------------
+
+        private:
+            juce::File m_File;
+            int m_Channels;
+            int m_Samples;
+
+            // ------------------------------------------------
+
+        };
+
+        // ------------------------------------------------
+
+        struct Entry {
+            std::shared_ptr<const Buffer> buffer{};
+            bool spilled = false; // The buffer views a mapped file, so it's not in memory
+        };
+
+        // ------------------------------------------------
+
+        mutable std::mutex m_Mutex{};
+        std::map<Transform, Entry> m_Cache{};
+        std::size_t m_Budget = DefaultBudget;
+        std::size_t m_Bytes = 0;    // Of the entries that aren't spilled
+        bool m_Spilling = false;    // A spill job is scheduled or running
+        TaskScheduler::Lane m_Spills{}; // Last, so it's destroyed first
+
+        // ------------------------------------------------
+
+        // Schedules a spill job if over budget and none is scheduled yet, requires m_Mutex.
+        void spillOverBudget();
+
+        // Spills entries until the budget is met, or nothing can be spilled anymore.
+        void spill();
+
+        // @returns a copy in memory of a spilled buffer, stored in its place if it's still cached.
+        std::shared_ptr<const Buffer> readBack(Transform t, std::shared_ptr<const Buffer> spilled);
 
         // ------------------------------------------------
 
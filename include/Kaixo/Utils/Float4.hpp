@@ -0,0 +1,108 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KAIXO_FLOAT4_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define KAIXO_FLOAT4_NEON 1
+#include <arm_neon.h>
+#endif
+
+// ------------------------------------------------
+
+namespace Kaixo {
+
+    // ------------------------------------------------
+
+    /**
+        Minimal 4-wide float vector. Uses SSE2 or NEON when the target architecture
+        guarantees it (x64 and arm64 always do), and plain scalar code otherwise.
+     */
+    struct Float4 {
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t Width = 4;
+
+        // ------------------------------------------------
+
+#if KAIXO_FLOAT4_SSE
+        __m128 value;
+
+        static Float4 load(const float* ptr) { return { _mm_loadu_ps(ptr) }; }
+        static Float4 broadcast(float v) { return { _mm_set1_ps(v) }; }
+        static Float4 set(float a, float b, float c, float d) { return { _mm_setr_ps(a, b, c, d) }; }
+
+        void store(float* ptr) const { _mm_storeu_ps(ptr, value); }
+
+        friend Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.value, b.value) }; }
+        friend Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.value, b.value) }; }
+        friend Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.value, b.value) }; }
+
+        static Float4 min(Float4 a, Float4 b) { return { _mm_min_ps(a.value, b.value) }; }
+        static Float4 max(Float4 a, Float4 b) { return { _mm_max_ps(a.value, b.value) }; }
+#elif KAIXO_FLOAT4_NEON
+        float32x4_t value;
+
+        static Float4 load(const float* ptr) { return { vld1q_f32(ptr) }; }
+        static Float4 broadcast(float v) { return { vdupq_n_f32(v) }; }
+        static Float4 set(float a, float b, float c, float d) {
+            const float values[Width]{ a, b, c, d };
+            return load(values);
+        }
+
+        void store(float* ptr) const { vst1q_f32(ptr, value); }
+
+        friend Float4 operator+(Float4 a, Float4 b) { return { vaddq_f32(a.value, b.value) }; }
+        friend Float4 operator-(Float4 a, Float4 b) { return { vsubq_f32(a.value, b.value) }; }
+        friend Float4 operator*(Float4 a, Float4 b) { return { vmulq_f32(a.value, b.value) }; }
+
+        static Float4 min(Float4 a, Float4 b) { return { vminq_f32(a.value, b.value) }; }
+        static Float4 max(Float4 a, Float4 b) { return { vmaxq_f32(a.value, b.value) }; }
+#else
+        std::array<float, Width> value;
+
+        static Float4 load(const float* ptr) { return { { ptr[0], ptr[1], ptr[2], ptr[3] } }; }
+        static Float4 broadcast(float v) { return { { v, v, v, v } }; }
+        static Float4 set(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+
+        void store(float* ptr) const { for (std::size_t i = 0; i < Width; ++i) ptr[i] = value[i]; }
+
+        friend Float4 operator+(Float4 a, Float4 b) { return apply(a, b, [](float x, float y) { return x + y; }); }
+        friend Float4 operator-(Float4 a, Float4 b) { return apply(a, b, [](float x, float y) { return x - y; }); }
+        friend Float4 operator*(Float4 a, Float4 b) { return apply(a, b, [](float x, float y) { return x * y; }); }
+
+        static Float4 min(Float4 a, Float4 b) { return apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+        static Float4 max(Float4 a, Float4 b) { return apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+
+        static Float4 apply(Float4 a, Float4 b, auto op) {
+            Float4 result;
+            for (std::size_t i = 0; i < Width; ++i) result.value[i] = op(a.value[i], b.value[i]);
+            return result;
+        }
+#endif
+
+        // ------------------------------------------------
+
+        // @returns the sum of all 4 elements.
+        float sum() const {
+            float values[Width];
+            store(values);
+            return (values[0] + values[1]) + (values[2] + values[3]);
+        }
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
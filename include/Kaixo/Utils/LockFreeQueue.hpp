@@ -0,0 +1,110 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo {
+
+    // ------------------------------------------------
+
+    /**
+        Bounded multi-producer multi-consumer queue, based on Dmitry Vyukov's
+        design. Every cell has a sequence number that tells whether it is ready
+        to be written or read, so pushing and popping never block or allocate.
+     */
+    template<class Type, std::size_t Capacity>
+    class LockFreeQueue {
+        static_assert(std::has_single_bit(Capacity), "Capacity must be a power of 2");
+    public:
+
+        // ------------------------------------------------
+
+        LockFreeQueue() {
+            for (std::size_t i = 0; i < Capacity; ++i) {
+                m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // ------------------------------------------------
+
+        /** Push a value onto the queue.
+
+            @param value            the value to push.
+
+            @returns false if the queue is full, in which case the value is dropped.
+         */
+        bool push(Type value) {
+            std::size_t position = m_Enqueue.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = m_Cells[position & (Capacity - 1)];
+                std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                if (difference == 0) {
+                    if (m_Enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false; // Full
+                } else {
+                    position = m_Enqueue.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Pop a value from the queue.
+
+            @param value            receives the popped value.
+
+            @returns false if the queue is empty.
+         */
+        bool pop(Type& value) {
+            std::size_t position = m_Dequeue.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = m_Cells[position & (Capacity - 1)];
+                std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+                if (difference == 0) {
+                    if (m_Dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        value = std::move(cell.value);
+                        cell.value = Type{}; // Don't keep resources alive in the queue
+                        cell.sequence.store(position + Capacity, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false; // Empty
+                } else {
+                    position = m_Dequeue.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // ------------------------------------------------
+
+    private:
+        struct Cell {
+            std::atomic_size_t sequence{};
+            Type value{};
+        };
+
+        // ------------------------------------------------
+
+        std::array<Cell, Capacity> m_Cells{};
+        alignas(64) std::atomic_size_t m_Enqueue = 0;
+        alignas(64) std::atomic_size_t m_Dequeue = 0;
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
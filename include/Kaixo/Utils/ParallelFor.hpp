@@ -0,0 +1,37 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/TaskScheduler.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo {
+
+    // ------------------------------------------------
+
+    /** 
+        Runs a task for every index in [0, count), spread over the threads of the
+        shared scheduler. The calling thread takes part in the work, and never waits
+        on tasks that are still queued, so this can safely be nested inside a task
+        that is already running on the scheduler. Returns when every index has been
+        processed. Helpers stop taking indices while tasks of a higher priority are
+        waiting, so a long loop at a low priority doesn't hold up more urgent work,
+        the calling thread always finishes what they leave. If a task throws, the 
+        first exception is rethrown on the calling thread.
+
+        @param priority         priority of the helper tasks.
+        @param count            the amount of indices to process.
+        @param task             invoked once for every index.
+     */
+    void parallelFor(TaskPriority priority, std::size_t count, std::function<void(std::size_t)> task);
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
@@ -0,0 +1,267 @@
+#pragma once
+
+// ------------------------------------------------
+
+#include "Kaixo/Core/Definitions.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo {
+
+    // ------------------------------------------------
+
+    enum class TaskPriority {
+        Audio = 0,       // Prepares something the audio thread is waiting for
+        Interactive = 1, // Directly visible to the user, like rendering a display
+        Background = 2,  // Long running computations, like analyzing and transforming
+        IO = 3,          // Reading and writing files
+        Idle = 4,        // Speculative work that might never be needed
+        Amount
+    };
+
+    enum class TaskAccess {
+        Read,  // Only reads the resource, can run concurrently with other reads
+        Write, // Changes the resource, runs on its own
+    };
+
+    // ------------------------------------------------
+
+    /**
+        Process-wide pool of worker threads shared by every plugin instance, so the
+        amount of threads stays the same no matter how many instances are open.
+        Tasks are picked by priority. Tasks posted from a worker go to that worker's
+        own queue and are taken newest first, idle workers steal the oldest tasks
+        from the other workers. A running task is never interrupted, long running
+        tasks should check preempted() to leave the workers to more urgent work.
+     */
+    class TaskScheduler {
+    public:
+        using Task = std::function<void()>;
+
+        // ------------------------------------------------
+
+        static constexpr std::size_t Priorities = static_cast<std::size_t>(TaskPriority::Amount);
+
+        // ------------------------------------------------
+
+        /** The scheduler is shared by everything that holds it, and the threads are stopped 
+            when the last reference is released, instead of when the program exits, as
+            joining threads while a plugin library is unloaded can deadlock. Every lane holds
+            a reference, so it lives as long as a plugin instance is open. Tasks that are still
+            queued are finished before the threads stop. The last reference must not be 
+            released by a task of the scheduler itself.
+
+            @returns the scheduler shared by the whole process, created if nothing holds it.
+         */
+        static std::shared_ptr<TaskScheduler> shared();
+
+        // ------------------------------------------------
+
+        explicit TaskScheduler(std::size_t threads);
+        ~TaskScheduler();
+
+        // ------------------------------------------------
+
+        // @returns the amount of worker threads.
+        std::size_t threads() const { return m_Threads.size(); }
+
+        // @returns true if tasks of a higher priority than the given one are waiting.
+        bool preempted(TaskPriority priority) const;
+
+        // ------------------------------------------------
+
+        /** Post a task, the task must not throw.
+
+            @param priority         priority of the task.
+            @param task             the task.
+         */
+        void post(TaskPriority priority, Task task);
+
+        /** Push a task, exceptions are passed on through the future.
+
+            @param priority         priority of the task.
+            @param fun              the task.
+
+            @returns future to the result of the task.
+         */
+        template<class Fun>
+        auto push(TaskPriority priority, Fun&& fun) -> std::future<std::invoke_result_t<Fun>> {
+            using Result = std::invoke_result_t<Fun>;
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fun>(fun));
+            auto future = task->get_future();
+            post(priority, [task] { (*task)(); });
+            return future;
+        }
+
+        // ------------------------------------------------
+
+        /**
+            Runs its tasks one at a time on the scheduler, in the order they were
+            pushed. Every task runs at its own priority. Destroying a lane drops the
+            tasks that haven't started yet, and waits for the running task.
+         */
+        class Lane {
+        public:
+
+            // ------------------------------------------------
+
+            explicit Lane(std::shared_ptr<TaskScheduler> scheduler = TaskScheduler::shared());
+            ~Lane();
+
+            Lane(const Lane&) = delete;
+            Lane& operator=(const Lane&) = delete;
+
+            // ------------------------------------------------
+
+            /** Push a task onto the lane.
+
+                @param priority         priority of the task.
+                @param fun              the task.
+
+                @returns future to the result of the task.
+             */
+            template<class Fun>
+            auto push(TaskPriority priority, Fun&& fun) -> std::future<std::invoke_result_t<Fun>> {
+                using Result = std::invoke_result_t<Fun>;
+                auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fun>(fun));
+                auto future = task->get_future();
+                post(priority, [task] { (*task)(); });
+                return future;
+            }
+
+            // ------------------------------------------------
+
+        private:
+            struct Entry {
+                TaskPriority priority;
+                Task task;
+            };
+
+            // ------------------------------------------------
+
+            std::shared_ptr<TaskScheduler> m_Scheduler;
+            std::mutex m_Mutex{};
+            std::condition_variable m_Idle{};
+            std::deque<Entry> m_Tasks{};
+            bool m_Running = false; // A task of this lane is scheduled or running
+
+            // ------------------------------------------------
+
+            void post(TaskPriority priority, Task task);
+            void runNext();
+
+            // ------------------------------------------------
+
+        };
+
+        // ------------------------------------------------
+
+        /**
+            Runs tasks that read or write a shared resource, like a buffer. Every write
+            makes a new version of the resource, and a task depends on the version that
+            was current when it was pushed: it starts once all writes pushed before it
+            are done, and a write also waits for the reads pushed before it. Reads of
+            the same version run concurrently. Destroying the lane drops the tasks that
+            haven't started yet, and waits for the running tasks.
+         */
+        class ReadWriteLane {
+        public:
+
+            // ------------------------------------------------
+
+            explicit ReadWriteLane(std::shared_ptr<TaskScheduler> scheduler = TaskScheduler::shared());
+            ~ReadWriteLane();
+
+            ReadWriteLane(const ReadWriteLane&) = delete;
+            ReadWriteLane& operator=(const ReadWriteLane&) = delete;
+
+            // ------------------------------------------------
+
+            /** Push a task onto the lane.
+
+                @param access           whether the task reads or writes the resource.
+                @param priority         priority of the task.
+                @param fun              the task.
+
+                @returns future to the result of the task.
+             */
+            template<class Fun>
+            auto push(TaskAccess access, TaskPriority priority, Fun&& fun) -> std::future<std::invoke_result_t<Fun>> {
+                using Result = std::invoke_result_t<Fun>;
+                auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fun>(fun));
+                auto future = task->get_future();
+                post(access, priority, [task] { (*task)(); });
+                return future;
+            }
+
+            // ------------------------------------------------
+
+        private:
+            struct Entry {
+                TaskAccess access;
+                TaskPriority priority;
+                Task task;
+            };
+
+            // ------------------------------------------------
+
+            std::shared_ptr<TaskScheduler> m_Scheduler;
+            std::mutex m_Mutex{};
+            std::condition_variable m_Idle{};
+            std::deque<Entry> m_Tasks{}; // Not started yet, in the order they were pushed
+            std::size_t m_Reading = 0;   // Reads that are scheduled or running
+            bool m_Writing = false;      // A write is scheduled or running
+
+            // ------------------------------------------------
+
+            void post(TaskAccess access, TaskPriority priority, Task task);
+            void finish(TaskAccess access);
+
+            // Schedules every task whose dependencies are done, requires m_Mutex.
+            void schedule();
+
+            // ------------------------------------------------
+
+        };
+
+        // ------------------------------------------------
+
+    private:
+        struct Worker {
+            std::mutex mutex{};
+            std::array<std::deque<Task>, Priorities> tasks{};
+        };
+
+        // ------------------------------------------------
+
+        std::mutex m_Mutex{};
+        std::condition_variable m_Wake{};
+        std::array<std::deque<Task>, Priorities> m_Tasks{}; // Posted from outside the workers
+        std::size_t m_Pending = 0; // Tasks in all queues, guarded by m_Mutex
+        std::array<std::atomic_size_t, Priorities> m_Waiting{}; // Tasks in all queues, per priority
+        bool m_Stop = false;
+        std::vector<std::unique_ptr<Worker>> m_Workers{};
+        std::vector<std::thread> m_Threads{};
+
+        // ------------------------------------------------
+
+        void run(std::size_t worker);
+
+        /** Take the next task for a worker.
+
+            @param worker           index of the worker.
+            @param task             receives the task.
+
+            @returns false if no task was found.
+         */
+        bool take(std::size_t worker, Task& task);
+
+        // ------------------------------------------------
+
+    };
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
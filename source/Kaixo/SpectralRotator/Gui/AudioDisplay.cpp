@@ -40,6 +40,10 @@ namespace Kaixo::Gui {
         wantsIdle(true);
     }
 
+    AudioDisplay::~AudioDisplay() {
+        stopRefresh();
+    }
+
     // ------------------------------------------------
 
     void AudioDisplay::bufferChanged() {
@@ -55,7 +59,7 @@ namespace Kaixo::Gui {
     void AudioDisplay::zoomChanged(Point<float> zoom) {
         m_ZoomMillis = zoom;
         if (m_EnableZoom) {
-            m_Dirty = true;
+            m_Scrolled = true;
         }
     }
 
@@ -76,8 +80,16 @@ namespace Kaixo::Gui {
     void AudioDisplay::onIdle() {
         View::onIdle();
         if (m_RefreshFuture.valid() && m_RefreshFuture.wait_for(0ms) == std::future_status::ready) {
-            KAIXO_DEBUG("Image refresh finished.");
-            repaint();
+            if (m_RefreshFuture.get()) {
+                KAIXO_DEBUG("Image refresh finished.");
+                m_LastDisplay = std::chrono::steady_clock::now();
+                repaint();
+            } else {
+                KAIXO_DEBUG("Image refresh was canceled.");
+                // The content it was refreshing for still has to be rendered
+                if (m_RefreshFull) m_Dirty = true;
+            }
+
             m_RefreshFuture = {};
         }
 
@@ -90,23 +102,101 @@ namespace Kaixo::Gui {
             }
         }
 
-        if (m_Dirty && !m_RefreshFuture.valid()) {
+        // The visible range changed, so the refresh in progress is stale, and restarted for the new range. 
+        // Unless no image was shown for a while, then it's left to finish, otherwise continuously zooming would
+        // never show anything. Content changes don't cancel, otherwise streamed analyze results would never be shown.
+        if (m_Scrolled && m_RefreshFuture.valid() && std::chrono::steady_clock::now() - m_LastDisplay < MinDisplayInterval) {
+            m_RefreshCanceled->store(true);
+        }
+
+        // Only starts once the previous refresh is done, so bursts of changes are coalesced into one.
+        if ((m_Dirty || m_Scrolled) && !m_RefreshFuture.valid()) {
             KAIXO_DEBUG("Image was marked as dirty, triggering new refresh.");
+            const bool full = m_Dirty;
             m_Dirty = false;
+            m_Scrolled = false;
             if (width() <= 0 || height() <= 0) return; // Invalid size
-            m_RefreshFuture = m_RefreshPool.push([this, visible = visibleMillis(), imageSize = size()] {
+            m_RefreshFull = full;
+            m_RefreshCanceled = std::make_shared<std::atomic_bool>(false);
+            m_RefreshFuture = m_RefreshLane.push(TaskPriority::Interactive, [this, full, canceled = m_RefreshCanceled, visible = visibleMillis(), imageSize = size()] {
+                if (canceled->load()) return false; // Stale before it started
+
                 KAIXO_DEBUG("Refreshing image.");
-                auto result = refreshImage(visible, imageSize);
+                auto result = full ? refreshImage(visible, imageSize, *canceled) : scrollImage(visible, imageSize, *canceled);
+                if (canceled->load(std::memory_order_relaxed)) return false; // Partially rendered
+
                 {
                     auto _ = m_ImageLock.write();
                     m_Image = std::move(result);
                 }
+
+                return true;
             });
         }
     }
 
     // ------------------------------------------------
 
+    void AudioDisplay::stopRefresh() {
+        if (!m_RefreshFuture.valid()) return;
+        m_RefreshCanceled->store(true);
+        m_RefreshFuture.wait();
+    }
+
+    // ------------------------------------------------
+
+    AudioFileImage AudioDisplay::refreshImage(Point<float> visible, Point<int> size, const std::atomic_bool& canceled) {
+        AudioFileImage result;
+        result.image = juce::Image{ juce::Image::PixelFormat::ARGB, size.x(), size.y(), true, juce::SoftwareImageType() };
+        result.selection = visible;
+        renderColumns(result, 0, size.x(), canceled);
+        return result;
+    }
+
+    AudioFileImage AudioDisplay::scrollImage(Point<float> visible, Point<int> size, const std::atomic_bool& canceled) {
+        // Only the refresh thread replaces the image, so it can be read here without locking
+        const AudioFileImage& previous = m_Image;
+
+        const int w = size.x();
+        const int h = size.y();
+        const float length = visible.y() - visible.x();
+        const float previousLength = previous.selection.y() - previous.selection.x();
+
+        const bool sameSize = previous.image.isValid() && previous.image.getWidth() == w && previous.image.getHeight() == h;
+        const bool sameScale = length > 0 && Math::abs(length - previousLength) <= length * 1e-5f;
+        if (!sameSize || !sameScale) return refreshImage(visible, size, canceled);
+
+        // Shift by whole pixels, the sub-pixel remainder is handled when drawing the image
+        const float millisPerPixel = previousLength / w;
+        const int shift = static_cast<int>(std::lround((visible.x() - previous.selection.x()) / millisPerPixel));
+        if (shift == 0) return previous;
+        if (Math::abs(shift) >= w) return refreshImage(visible, size, canceled);
+
+        AudioFileImage result;
+        result.image = juce::Image{ juce::Image::PixelFormat::ARGB, w, h, true, juce::SoftwareImageType() };
+        result.selection = { previous.selection.x() + shift * millisPerPixel, previous.selection.y() + shift * millisPerPixel };
+
+        // Copy the columns that are still visible, the previous image is shared with paint, so it's left untouched
+        const int kept = w - Math::abs(shift);
+        const int from = Math::max(shift, 0);
+        const int to = Math::max(-shift, 0);
+
+        {
+            juce::Image::BitmapData source{ previous.image, juce::Image::BitmapData::readOnly };
+            juce::Image::BitmapData destination{ result.image, juce::Image::BitmapData::writeOnly };
+            for (int y = 0; y < h; ++y) {
+                std::memcpy(destination.getPixelPointer(to, y), source.getPixelPointer(from, y), static_cast<std::size_t>(kept * source.pixelStride));
+            }
+        }
+
+        if (shift > 0) renderColumns(result, kept, w, canceled);
+        else renderColumns(result, 0, -shift, canceled);
+
+        return result;
+    }
+
+    // ------------------------------------------------
+
     Point<float> AudioDisplay::visibleMillis() const {
         if (m_EnableZoom) return m_ZoomMillis;
         else return { 0, Convert::samplesToMillis(interface->timelineLength(), interface->buffer().sampleRate()) };
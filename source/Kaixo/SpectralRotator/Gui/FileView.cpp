@@ -248,10 +248,14 @@ namespace Kaixo::Gui {
             scheduleAnalyze();
         }
 
+        receiveAnalyzedBlocks();
+
         if (m_AnalyzeFuture.valid() && m_AnalyzeFuture.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
             KAIXO_DEBUG("Analyze finished, notifying spectral display to refresh image.");
 
-            context.window().notifyListeners(&AnalyzeResultListener::updateAnalyzeResult, m_AnalyzeFuture.get());
+            m_StreamedResult = {};
+            m_AnalyzeResult = m_AnalyzeFuture.get();
+            context.window().notifyListeners(&AnalyzeResultListener::updateAnalyzeResult, m_AnalyzeResult);
 
             m_AnalyzeFuture = {};
         }
@@ -264,15 +268,27 @@ namespace Kaixo::Gui {
     // ------------------------------------------------
 
     void FileView::zoomChanged(Point<float> zoom) {
+        const float center = (zoom.x() + zoom.y()) / 2;
+        const float previousCenter = (m_ZoomMillis.x() + m_ZoomMillis.y()) / 2;
+        if (center != previousCenter) m_PanDirection = center > previousCenter ? 1.f : -1.f;
+
         m_ZoomMillis = zoom;
+
+        // Only the tiles around the visible range are analyzed, at a stride that fits the zoom
+        if (m_AnalyzeResult && !m_AnalyzeResult->covers(zoom.x(), zoom.y(), millisPerPixel())) {
+            scheduleAnalyze();
+        }
     }
 
     // ------------------------------------------------
 
     void FileView::updateAnalyzeSettings(const Processing::AnalyzeSettings& v) {
         KAIXO_DEBUG("Analyze settings updated!");
+        bool requiresAnalyze = m_AnalyzeSettings.requiresAnalyze(v);
         m_AnalyzeSettings = v;
-        scheduleAnalyze();
+
+        // The spectral display applies the dynamic range itself
+        if (requiresAnalyze) scheduleAnalyze();
     }
 
     void FileView::updateFileLoadSettings(const Processing::FileLoadSettings& v) {
@@ -317,6 +333,21 @@ namespace Kaixo::Gui {
         m_AnalyzeDirty = true;
     }
 
+    void FileView::receiveAnalyzedBlocks() {
+        Processing::AnalyzedBlocks blocks;
+        while (interface->analyzedBlocks(blocks)) {
+            if (!m_AnalyzeFuture.valid()) continue; // Left over from a finished analyze
+
+            // First blocks of a new analyze, show the partial result
+            if (blocks.result != m_StreamedResult) {
+                m_StreamedResult = blocks.result;
+                context.window().notifyListeners(&AnalyzeResultListener::updateAnalyzeResult, m_StreamedResult);
+            }
+
+            context.window().notifyListeners(&AnalyzeResultListener::analyzedBlocks, blocks);
+        }
+    }
+
     // ------------------------------------------------
 
     void FileView::updateZoomBounds(bool setZoom) {
@@ -327,6 +358,10 @@ namespace Kaixo::Gui {
         }
     }
 
+    float FileView::millisPerPixel() const {
+        return (m_ZoomMillis.y() - m_ZoomMillis.x()) / Math::max(static_cast<float>(width()), 1.f);
+    }
+
     // ------------------------------------------------
 
     bool FileView::waitingForLoad() const { return m_LoadFuture.valid(); }
@@ -352,7 +387,7 @@ namespace Kaixo::Gui {
         }
 
         m_AnalyzeDirty = false;
-        m_AnalyzeFuture = interface->analyze(m_AnalyzeSettings);
+        m_AnalyzeFuture = interface->analyze(m_AnalyzeSettings, { m_ZoomMillis.x(), m_ZoomMillis.y(), m_PanDirection, millisPerPixel() });
     }
 
     // ------------------------------------------------
@@ -43,6 +43,19 @@ namespace Kaixo::Gui {
 
     void SelectionDisplay::onIdle() {
         View::onIdle();
+
+        // Once the selection stops changing, its rotation is computed ahead of time
+        const auto now = std::chrono::steady_clock::now();
+        const Processing::Selection selection = interface->selection();
+        if (selection != m_LastSelection) {
+            m_LastSelection = selection;
+            m_SelectionChanged = now;
+            m_Settled = false;
+        } else if (!m_Settled && m_DragMode == DragMode::None && now - m_SelectionChanged >= settleTime) {
+            m_Settled = true;
+            interface->precompute();
+        }
+
         repaint();
     }
 
@@ -47,6 +47,15 @@ namespace Kaixo::Gui {
             .transform = Transformers::Range<48.f, 144.f>,
             .resetValue = Transformers::Range<48.f, 144.f>.normalize(75.f),
         });
+
+        add<Knob>("playback-quality", { Width, 20 }, {
+            .onchange = [this](ParamValue val) { Config::UserSettings["playback-quality"] = val; updatePlaybackSettings(); },
+            .name = "Playback Quality",
+            .steps = 3,
+            .format = Formatters::Group<"Draft", "Normal", "High">,
+            .transform = Transformers::Group<3>,
+            .resetValue = Convert::indexToParam(1, 3),
+        });
         
         // ------------------------------------------------
 
@@ -109,6 +118,7 @@ namespace Kaixo::Gui {
 
         updateAnalyzeSettings();
         updateFileLoadSettings();
+        updatePlaybackSettings();
 
         // ------------------------------------------------
 
@@ -164,6 +174,14 @@ namespace Kaixo::Gui {
         context.window().notifyListeners(&SettingsListener::updateAnalyzeSettings, analyzeSettings);
     }
 
+    void SettingsView::updatePlaybackSettings() {
+        if (auto quality = Config::UserSettings["playback-quality"].get<float>()) {
+            constexpr Processing::ResamplerQuality Values[]{ Processing::ResamplerQuality::Draft, Processing::ResamplerQuality::Normal, Processing::ResamplerQuality::High };
+            if (auto knob = find<Knob>("playback-quality")) knob->get().value(*quality);
+            interface->quality(Values[Math::clamp(Convert::paramToIndex(*quality, 3), 0, 2)]);
+        }
+    }
+
     // ------------------------------------------------
 
     void SettingsView::chooseGenerationDirectory() {
@@ -5,6 +5,11 @@
 
 // ------------------------------------------------
 
+#include "Kaixo/Utils/Float4.hpp"
+#include "Kaixo/Utils/ParallelFor.hpp"
+
+// ------------------------------------------------
+
 namespace Kaixo::Gui {
     
     // ------------------------------------------------
@@ -13,30 +18,57 @@ namespace Kaixo::Gui {
         : AudioDisplay(c)
     {}
 
+    SpectralDisplay::~SpectralDisplay() {
+        stopRefresh(); // Refreshes render through this
+    }
+
     // ------------------------------------------------
 
-    void SpectralDisplay::updateAnalyzeResult(const Processing::AnalyzeResult& r) {
+    void SpectralDisplay::updateAnalyzeResult(std::shared_ptr<const Processing::AnalyzeResult> r) {
         KAIXO_DEBUG("Receiving a new analyze result.");
         std::lock_guard _{ m_AnalyzeResultMutex };
-        m_AnalyzeResult = r;
+        m_AnalyzeResult = std::move(r);
+        m_Dirty = true;
+    }
+
+    void SpectralDisplay::analyzedBlocks(const Processing::AnalyzedBlocks& blocks) {
+        // Refreshes are not started while one is in progress, so bursts of blocks are coalesced
+        const float resolution = blocks.result->resolution();
+        const float start = blocks.first * resolution;
+        const float end = blocks.last * resolution;
+        const Point<float> visible = visibleMillis();
+        if (end >= visible.x() && start <= visible.y()) {
+            m_Dirty = true;
+        }
+    }
+
+    void SpectralDisplay::updateAnalyzeSettings(const Processing::AnalyzeSettings& v) {
+        if (m_Range == v.fftRange) return;
+        m_Range = v.fftRange;
         m_Dirty = true;
     }
 
     // ------------------------------------------------
 
-    AudioFileImage SpectralDisplay::refreshImage(Point<float> visible, Point<int> size) {
-        KAIXO_DEBUG("Refreshing image with zoom {} {}.", visible.x(), visible.y());
+    void SpectralDisplay::renderColumns(AudioFileImage& image, int firstColumn, int lastColumn, const std::atomic_bool& canceled) {
+        const Point<float> visible = image.selection;
+        KAIXO_DEBUG("Rendering columns [{}, {}) with zoom {} {}.", firstColumn, lastColumn, visible.x(), visible.y());
 
         m_AnalyzeResultMutex.lock();
-        Processing::AnalyzeResult analyzeResult = m_AnalyzeResult; // Working copy
+        auto analyzeResult = m_AnalyzeResult; // Keeps the result alive while drawing
         m_AnalyzeResultMutex.unlock();
 
-        const int w = size.x();
-        const int h = size.y();
+        static const Processing::AnalyzeResult Empty{};
+        const Processing::AnalyzeResult& data = analyzeResult ? *analyzeResult : Empty;
+
+        const float range = m_Range;
+
+        const int w = image.image.getWidth();
+        const int h = image.image.getHeight();
+        const int columnCount = lastColumn - firstColumn;
+        if (columnCount <= 0) return;
 
-        AudioFileImage result;
-        result.image = juce::Image{ juce::Image::PixelFormat::ARGB, w, h, true, juce::SoftwareImageType()};
-        result.selection = visible;
+        // ------------------------------------------------
 
         const Color c1 = color1;
         const Color c2 = color2;
@@ -44,21 +76,130 @@ namespace Kaixo::Gui {
         const Color c4 = color4;
         const Color c5 = color5;
 
-        for (int y = 0; y < h; ++y) {
-            float normalizedFrequency = 1.f - static_cast<float>(y) / h;
+        // Intensity is mapped to one of the colors of a gradient
+        std::array<juce::PixelARGB, ColorSteps> colors;
+        for (std::size_t i = 0; i < ColorSteps; ++i) {
+            const float intensity = static_cast<float>(i) / (ColorSteps - 1);
+            colors[i] = juce::Colour{ Color::lerp(intensity, c1, c2, c3, c4, c5) }.getPixelARGB();
+        }
 
-            for (int x = 0; x < w; ++x) {
-                float intensity = 0;
-                for (float sx = 0; sx < 1; sx += 0.1f) {
-                    float millis = Math::remap(x + sx, 0, w, visible.x(), visible.y());
-                    intensity += analyzeResult.intensityAt(millis, normalizedFrequency);
-                }
-                intensity /= 10;
-                result.image.setPixelAt(x, y, Color::lerp(intensity, c1, c2, c3, c4, c5));
+        // ------------------------------------------------
+
+        // Read from the level of the pyramid that has at most a few blocks per pixel,
+        // and take one sample per block, so the cost only depends on the image size.
+        const float millisPerPixel = (visible.y() - visible.x()) / Math::max(w, 1);
+        const std::size_t level = data.level(millisPerPixel);
+        const float blocksPerBlock = static_cast<float>(Processing::AnalyzeResult::blocksPerBlock(level));
+        const float millisPerBlock = data.resolution() * blocksPerBlock;
+        const int samples = std::clamp(static_cast<int>(Math::ceil(millisPerPixel / millisPerBlock)), 1, static_cast<int>(Processing::AnalyzeResult::Reduction));
+
+        // Blocks that haven't been analyzed read as silence
+        const std::vector<std::int16_t> silence(Math::max(data.bins(), 1), Processing::SpectrogramTile::quantize(-144));
+
+        // The blocks that every column interpolates between only depend on x, look them up once,
+        // columns are padded to a multiple of the vector width, so rows can be processed 4 at a time.
+        struct Sample {
+            const std::int16_t* block1;
+            const std::int16_t* block2;
+            float blockRatio;
+        };
+
+        const int paddedCount = (columnCount + Float4::Width - 1) / Float4::Width * Float4::Width;
+        std::vector<Sample> columns(static_cast<std::size_t>(paddedCount * samples));
+        for (int column = 0; column < paddedCount; ++column) {
+            const int x = firstColumn + column;
+            for (int sample = 0; sample < samples; ++sample) {
+                const float millis = Math::remap(x + static_cast<float>(sample) / samples, 0, w, visible.x(), visible.y());
+                
+                // A block of a coarser level is centered on the blocks it averages
+                const float block = (millis / data.resolution() - (blocksPerBlock - 1) / 2) / blocksPerBlock;
+                const std::int64_t block1 = static_cast<std::int64_t>(std::floor(block));
+                const std::int16_t* block1data = data.block(block1, level);
+                const std::int16_t* block2data = data.block(block1 + 1, level);
+
+                columns[column * samples + sample] = {
+                    .block1 = block1data ? block1data : silence.data(),
+                    .block2 = block2data ? block2data : silence.data(),
+                    .blockRatio = block - block1,
+                };
             }
         }
 
-        return result;
+        // Same for the bins of every row, which only depend on y
+        struct Bins {
+            std::size_t bin1;
+            std::size_t bin2;
+            float binRatio;
+        };
+
+        std::vector<Bins> rows(static_cast<std::size_t>(h));
+        const std::size_t lastBin = silence.size() - 1;
+        for (int y = 0; y < h; ++y) {
+            const float normalizedFrequency = 1.f - static_cast<float>(y) / h;
+            const float bin = normalizedFrequency * (data.settings.fftSize / 2);
+            const std::size_t bin1 = static_cast<std::size_t>(bin);
+
+            rows[y] = {
+                .bin1 = Math::min(bin1, lastBin),
+                .bin2 = Math::min(bin1 + 1, lastBin),
+                .binRatio = bin - bin1,
+            };
+        }
+
+        // ------------------------------------------------
+
+        // Decibels are still quantized, so the intensity is scaled in one go
+        const Float4 toIntensity = Float4::broadcast(1.f / (Processing::SpectrogramTile::StepsPerDecibel * range * samples));
+        const Float4 one = Float4::broadcast(1.f);
+        const Float4 zero = Float4::broadcast(0.f);
+        const Float4 toColor = Float4::broadcast(ColorSteps - 1);
+
+        juce::Image::BitmapData bitmap{ image.image, juce::Image::BitmapData::writeOnly };
+
+        constexpr int RowsPerTask = 8;
+        const std::size_t tasks = static_cast<std::size_t>((h + RowsPerTask - 1) / RowsPerTask);
+
+        parallelFor(TaskPriority::Interactive, tasks, [&](std::size_t task) {
+            const int firstRow = static_cast<int>(task) * RowsPerTask;
+            const int lastRow = Math::min(firstRow + RowsPerTask, h);
+
+            for (int y = firstRow; y < lastRow; ++y) {
+                if (canceled.load(std::memory_order_relaxed)) return;
+
+                const Bins& row = rows[y];
+                const Float4 binRatio = Float4::broadcast(row.binRatio);
+                auto* pixels = bitmap.getLinePointer(y);
+
+                for (int column = 0; column < columnCount; column += Float4::Width) {
+                    Float4 sum = zero;
+                    for (int sample = 0; sample < samples; ++sample) {
+                        const Sample* s = &columns[column * samples + sample];
+                        const std::size_t stride = static_cast<std::size_t>(samples);
+
+                        const Float4 value11 = Float4::set(s[0].block1[row.bin1], s[stride].block1[row.bin1], s[2 * stride].block1[row.bin1], s[3 * stride].block1[row.bin1]);
+                        const Float4 value12 = Float4::set(s[0].block1[row.bin2], s[stride].block1[row.bin2], s[2 * stride].block1[row.bin2], s[3 * stride].block1[row.bin2]);
+                        const Float4 value21 = Float4::set(s[0].block2[row.bin1], s[stride].block2[row.bin1], s[2 * stride].block2[row.bin1], s[3 * stride].block2[row.bin1]);
+                        const Float4 value22 = Float4::set(s[0].block2[row.bin2], s[stride].block2[row.bin2], s[2 * stride].block2[row.bin2], s[3 * stride].block2[row.bin2]);
+                        const Float4 blockRatio = Float4::set(s[0].blockRatio, s[stride].blockRatio, s[2 * stride].blockRatio, s[3 * stride].blockRatio);
+
+                        const Float4 value1 = value11 + (value12 - value11) * binRatio;
+                        const Float4 value2 = value21 + (value22 - value21) * binRatio;
+                        sum = sum + value1 + (value2 - value1) * blockRatio;
+                    }
+
+                    const Float4 intensity = Float4::min(Float4::max(sum * toIntensity + one, zero), one);
+
+                    float index[Float4::Width];
+                    (intensity * toColor).store(index);
+
+                    const int count = Math::min(static_cast<int>(Float4::Width), columnCount - column);
+                    for (int i = 0; i < count; ++i) {
+                        const juce::PixelARGB color = colors[static_cast<std::size_t>(index[i] + 0.5f)];
+                        std::memcpy(pixels + (firstColumn + column + i) * bitmap.pixelStride, &color, sizeof(color));
+                    }
+                }
+            }
+        });
     }
 
     // ------------------------------------------------
@@ -5,45 +5,26 @@
 
 // ------------------------------------------------
 
+#include "Kaixo/SpectralRotator/Processing/SincTable.hpp"
+
+// ------------------------------------------------
+
 namespace Kaixo::Gui {
     
     // ------------------------------------------------
 
-    constexpr int SincRadius = 16;
-
-    float sinc(float x) {
-        if (Math::abs(x) < 1.0e-6f) return 1.f;
-        x *= Math::pi;
-        return Math::sin(x) / x;
-    }
-
-    float blackman(float x) {
-        return 0.42f + 0.5f * Math::cos(x) + 0.08f * Math::cos(2.f * x);
-    }
+    constexpr int SincRadius = static_cast<int>(Processing::SincTable::Radius);
 
     // ------------------------------------------------
 
-    float sampleAtSinc(Processing::SafeAudioBuffer::ReadBuffer& bfr, int center, float r) {
-        float sum = 0.f;
-        float norm = 0.f;
-
-        for (int i = -SincRadius; i <= SincRadius; ++i) {
-            int index = center + i;
-            float d = r - static_cast<float>(i);
-            float w = sinc(d) * blackman(d * Math::pi / SincRadius);
-
-            float sample = bfr[index].average();
-
-            sum += sample * w;
-            norm += w;
-        }
-
-        return norm != 0.f ? sum / norm : 0.f;
+    // 'samples' must contain SincTable::PaddedTaps samples, starting SincRadius samples before the center.
+    float sampleAtSinc(std::span<const float> samples, int center, float r) {
+        return Processing::SincTable::instance().interpolate(samples.data() + (center - SincRadius), r);
     }
 
-    float sampleAtLinear(Processing::SafeAudioBuffer::ReadBuffer& bfr, int center, float r) {
-        float a = bfr[static_cast<int>(center)].average();
-        float b = bfr[static_cast<int>(center) + 1].average();
+    float sampleAtLinear(std::span<const float> samples, int center, float r) {
+        float a = samples[center];
+        float b = samples[center + 1];
         return Math::lerp(r, a, b);
     }
 
@@ -53,17 +34,19 @@ namespace Kaixo::Gui {
         : AudioDisplay(c)
     {}
 
-    // ------------------------------------------------
+    WaveformDisplay::~WaveformDisplay() {
+        stopRefresh(); // Refreshes render through this
+    }
 
-    AudioFileImage WaveformDisplay::refreshImage(Point<float> visible, Point<int> size) {
-        KAIXO_DEBUG("Refreshing image with zoom {} {}.", visible.x(), visible.y());
+    // ------------------------------------------------
 
-        const int w = size.x();
-        const int h = size.y();
+    void WaveformDisplay::renderColumns(AudioFileImage& image, int firstColumn, int lastColumn, const std::atomic_bool& canceled) {
+        const Point<float> visible = image.selection;
+        KAIXO_DEBUG("Rendering columns [{}, {}) with zoom {} {}.", firstColumn, lastColumn, visible.x(), visible.y());
 
-        AudioFileImage result;
-        result.image = juce::Image{ juce::Image::PixelFormat::ARGB, w, h, true, juce::SoftwareImageType() };
-        result.selection = visible;
+        const int w = image.image.getWidth();
+        const int h = image.image.getHeight();
+        if (lastColumn <= firstColumn) return;
 
         auto& buffer = interface->buffer();
 
@@ -77,60 +60,109 @@ namespace Kaixo::Gui {
 
         float samplesPerPixel = visibleSamples / Math::max(1.f, w);
 
-        juce::Graphics g(result.image);
+        // Column x always shows the same point in time for the same scale, so
+        // columns rendered separately line up when the image is scrolled.
+        auto columnToSample = [&](double x) {
+            return Math::remap(x, 0.0, static_cast<double>(w), static_cast<double>(startSample), static_cast<double>(endSample));
+        };
+
+        juce::Graphics g(image.image);
+        g.reduceClipRegion(firstColumn, 0, lastColumn - firstColumn, h);
         g.setColour(stroke);
 
         auto sampleToY = [&](float sample) {
             return Math::remap(Math::clamp11(sample), -1.f, 1.f, h, 0.f);
         };
 
+        auto drawEnvelope = [&](int x, float minV, float maxV) {
+            float startY = sampleToY(minV);
+            float endY = Math::min(sampleToY(maxV), startY - 1);
+
+            g.drawLine(static_cast<float>(x) + 0.5f, startY, static_cast<float>(x) + 0.5f, endY, 1.f);
+        };
+
+        // With many samples per pixel, the peaks are taken from the pyramid, its blocks
+        // are small enough compared to a pixel that rounding to whole blocks isn't visible.
+        if (samplesPerPixel > 4 * Processing::PeakPyramid::BaseSize) {
+            auto peaks = interface->peaks();
+            for (int x = firstColumn; x < lastColumn; ++x) {
+                if (canceled.load(std::memory_order_relaxed)) return;
+
+                std::int64_t start = static_cast<std::int64_t>(Math::floor(columnToSample(x)));
+                std::int64_t end = static_cast<std::int64_t>(Math::ceil(columnToSample(x + 1)));
+                auto peak = peaks->peak(start, end);
+                drawEnvelope(x, peak.min, peak.max);
+            }
+
+            return;
+        }
+
         interface->buffer().access([&](Processing::SafeAudioBuffer::ReadBuffer bfr) {
             // draw min/max envelope
             if (samplesPerPixel > 1.f) {
-                for (int x = 0; x < w; ++x) {
-                    float s0 = Math::remap(x, 0.f, w, startSample, endSample);
-                    float s1 = Math::remap(x + 1, 0.f, w, startSample, endSample);
+                std::vector<float> samples{};
+                for (int x = firstColumn; x < lastColumn; ++x) {
+                    if (canceled.load(std::memory_order_relaxed)) return;
+
+                    float s0 = static_cast<float>(columnToSample(x));
+                    float s1 = static_cast<float>(columnToSample(x + 1));
                     int start = static_cast<int>(Math::floor(s0));
                     int end = static_cast<int>(Math::max(start + 1, Math::ceil(s1))); 
+
+                    samples.resize(end - start);
+                    bfr.readMono(start, samples);
                     
                     float minV = 1.f;
                     float maxV = -1.f;
 
-                    for (int i = start; i < end; ++i) {
-                        float v = bfr[i].average();
+                    for (float v : samples) {
 
                         minV = Math::Fast::min(minV, v);
                         maxV = Math::Fast::max(maxV, v);
                     }
 
-                    float startY = sampleToY(minV);
-                    float endY = Math::min(sampleToY(maxV), startY - 1);
-
-                    g.drawLine(static_cast<float>(x) + 0.5f, startY, static_cast<float>(x) + 0.5f, endY, 1.f);
+                    drawEnvelope(x, minV, maxV);
                 }
             } else { // draw antialiased path
                 juce::Path path;
 
                 bool useSinc = samplesPerPixel < 1.f;
 
-                for (int x = 0; x < w; ++x) {
-                    double samplePos = Math::remap(x, 0.0, w - 1.0, startSample, endSample);
-                    int center = static_cast<int>(samplePos);
+                // The path is drawn a few columns beyond the range on both sides, so it and the
+                // sample dots connect to the neighbouring columns, the clip region keeps those intact.
+                constexpr int Margin = 3;
+                const int firstX = Math::max(firstColumn - Margin, 0);
+                const int lastX = Math::min(lastColumn + Margin, w);
+                const double firstSample = columnToSample(firstX);
+                const double lastSample = columnToSample(lastX);
+
+                // At most about 1 sample per pixel is visible, so read all of them at once,
+                // including the samples around the edges used for interpolation.
+                const int first = static_cast<int>(Math::floor(firstSample)) - SincRadius - 1;
+                const int last = static_cast<int>(Math::ceil(lastSample)) + static_cast<int>(Processing::SincTable::PaddedTaps) + 1;
+                std::vector<float> samples(static_cast<std::size_t>(Math::max(last - first, 0)));
+                bfr.readMono(first, samples);
+
+                for (int x = firstX; x < lastX; ++x) {
+                    if (canceled.load(std::memory_order_relaxed)) return;
+
+                    double samplePos = columnToSample(x);
+                    int center = static_cast<int>(Math::floor(samplePos));
                     float r = static_cast<float>(samplePos - center);
 
-                    float value = useSinc ? sampleAtSinc(bfr, center, r) : sampleAtLinear(bfr, center, r);
+                    float value = useSinc ? sampleAtSinc(samples, center - first, r) : sampleAtLinear(samples, center - first, r);
 
                     float y = sampleToY(value);
 
-                    if (x == 0) path.startNewSubPath(static_cast<float>(x), y);
+                    if (x == firstX) path.startNewSubPath(static_cast<float>(x), y);
                     else path.lineTo(static_cast<float>(x), y);
                 }
 
                 g.strokePath(path, juce::PathStrokeType(1.f, juce::PathStrokeType::curved, juce::PathStrokeType::rounded));
 
                 if (samplesPerPixel < 0.125f) {
-                    for (int sample = static_cast<int>(startSample); sample < endSample; ++sample) {
-                        float a = bfr[sample].average();
+                    for (int sample = static_cast<int>(Math::ceil(firstSample)); sample < lastSample; ++sample) {
+                        float a = samples[sample - first];
 
                         float x = static_cast<float>(Math::remap(sample, startSample, endSample, double(0.0), w));
                         float y = sampleToY(a);
@@ -140,8 +172,6 @@ namespace Kaixo::Gui {
                 }
             }
         });
-
-        return result;
     }
 
     // ------------------------------------------------
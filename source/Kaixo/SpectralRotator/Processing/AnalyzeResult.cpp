@@ -9,12 +9,101 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
-    float AnalyzeResult::intensityAt(float millis, float normalizedFrequency) {
-        const float block = millis / settings.fftResolution;
+    bool AnalyzeSettings::requiresAnalyze(const AnalyzeSettings& other) const {
+        return fftSize != other.fftSize || fftResolution != other.fftResolution;
+    }
+
+    // ------------------------------------------------
+
+    std::int64_t AnalyzeResult::stride(const AnalyzeSettings& settings, float pixel) {
+        // At most Reduction analyzed blocks per pixel, the same as a level of the pyramid
+        std::int64_t stride = 1;
+        while (settings.fftResolution * stride * Reduction <= pixel) {
+            stride *= Reduction;
+        }
+
+        return stride;
+    }
+
+    // ------------------------------------------------
+
+    AnalyzeResult::AnalyzeResult(AnalyzeSettings settings, float sampleRate, std::int64_t blocks, std::size_t bins, std::int64_t stride)
+        : settings(settings), sampleRate(sampleRate), m_Blocks(blocks), m_Bins(bins), m_Stride(stride)
+    {
+        m_Tiles.resize(static_cast<std::size_t>((blocks + TileBlocks - 1) / TileBlocks));
+    }
+
+    // ------------------------------------------------
+
+    std::int64_t AnalyzeResult::blocks() const { return m_Blocks; }
+    std::size_t AnalyzeResult::bins() const { return m_Bins; }
+    std::int64_t AnalyzeResult::tiles() const { return static_cast<std::int64_t>(m_Tiles.size()); }
+    std::int64_t AnalyzeResult::stride() const { return m_Stride; }
+    float AnalyzeResult::resolution() const { return settings.fftResolution * m_Stride; }
+
+    // ------------------------------------------------
+
+    void AnalyzeResult::tile(std::int64_t index, std::shared_ptr<const SpectrogramTile> tile) {
+        m_Tiles[index] = std::move(tile);
+    }
+
+    const SpectrogramTile* AnalyzeResult::tile(std::int64_t index) const {
+        if (index < 0 || index >= tiles()) return nullptr;
+        return m_Tiles[index].get();
+    }
+
+    // ------------------------------------------------
+
+    const std::int16_t* AnalyzeResult::block(std::int64_t block, std::size_t level) const {
+        if (block < 0 || level >= Levels) return nullptr;
+
+        // Tiles are aligned to the coarsest level, so every level has a fixed amount of blocks per tile
+        const std::int64_t tileBlocks = TileBlocks / blocksPerBlock(level);
+        const SpectrogramTile* tile = this->tile(block / tileBlocks);
+        if (tile == nullptr) return nullptr;
+
+        const std::size_t local = static_cast<std::size_t>(block % tileBlocks);
+        if (!tile->analyzed(local, level)) return nullptr;
+
+        return tile->block(local, level);
+    }
+
+    std::size_t AnalyzeResult::level(float millis) const {
+        std::size_t level = 0;
+        float duration = resolution() * Reduction;
+        while (level + 1 < Levels && duration <= millis) {
+            duration *= Reduction;
+            ++level;
+        }
+
+        return level;
+    }
+
+    bool AnalyzeResult::covers(float start, float end, float pixel) const {
+        if (m_Stride > stride(settings, pixel)) return false; // Zoomed in too far for the stride
+
+        const std::int64_t first = std::max<std::int64_t>(static_cast<std::int64_t>(start / resolution()), 0);
+        const std::int64_t last = std::min<std::int64_t>(static_cast<std::int64_t>(end / resolution()) + 1, m_Blocks - 1);
+        if (last < first) return true; // Nothing to analyze in the range
+
+        for (std::int64_t index = first / TileBlocks; index <= last / TileBlocks; ++index) {
+            const SpectrogramTile* tile = this->tile(index);
+            if (tile == nullptr || !tile->complete()) return false;
+        }
+
+        return true;
+    }
+
+    // ------------------------------------------------
+
+    float AnalyzeResult::decibelsAt(float millis, float normalizedFrequency, std::size_t level) const {
+        // A block of a coarser level is centered on the blocks it averages
+        const float scale = static_cast<float>(blocksPerBlock(level));
+        const float block = (millis / resolution() - (scale - 1) / 2) / scale;
         const float bin = normalizedFrequency * (settings.fftSize / 2);
-        const std::int64_t nofBlocks = static_cast<std::int64_t>(blocks.size());
+        const std::int64_t nofBins = static_cast<std::int64_t>(m_Bins);
 
-        const std::int64_t block1 = static_cast<std::int64_t>(block);
+        const std::int64_t block1 = static_cast<std::int64_t>(std::floor(block));
         const std::int64_t block2 = block1 + 1;
         const float blockRatio = block - block1;
 
@@ -24,31 +113,30 @@ namespace Kaixo::Processing {
 
         float intensity1 = -144, intensity2 = -144;
 
-        if (block1 >= 0 && block1 < nofBlocks) {
+        // Blocks that haven't been analyzed (yet) are silent
+        if (const std::int16_t* block1data = this->block(block1, level)) {
             float intensity11 = -144, intensity12 = -144;
 
-            const auto& block1data = blocks[block1];
-            const std::int64_t block1size = static_cast<std::int64_t>(block1data.result.size());
-
-            if (bin1 >= 0 && bin1 < block1size) intensity11 = block1data.result[bin1];
-            if (bin2 >= 0 && bin2 < block1size) intensity12 = block1data.result[bin2];
+            if (bin1 >= 0 && bin1 < nofBins) intensity11 = SpectrogramTile::dequantize(block1data[bin1]);
+            if (bin2 >= 0 && bin2 < nofBins) intensity12 = SpectrogramTile::dequantize(block1data[bin2]);
 
             intensity1 = Math::lerp(binRatio, intensity11, intensity12);
         }
 
-        if (block2 >= 0 && block2 < nofBlocks) {
+        if (const std::int16_t* block2data = this->block(block2, level)) {
             float intensity21 = -144, intensity22 = -144;
 
-            const auto& block2data = blocks[block2];
-            const std::int64_t block2size = static_cast<std::int64_t>(block2data.result.size());
-
-            if (bin1 >= 0 && bin1 < block2size) intensity21 = block2data.result[bin1];
-            if (bin2 >= 0 && bin2 < block2size) intensity22 = block2data.result[bin2];
+            if (bin1 >= 0 && bin1 < nofBins) intensity21 = SpectrogramTile::dequantize(block2data[bin1]);
+            if (bin2 >= 0 && bin2 < nofBins) intensity22 = SpectrogramTile::dequantize(block2data[bin2]);
 
             intensity2 = Math::lerp(binRatio, intensity21, intensity22);
         }
 
-        return Math::lerp(blockRatio, intensity1, intensity2) / settings.fftRange + 1;
+        return Math::lerp(blockRatio, intensity1, intensity2);
+    }
+
+    float AnalyzeResult::intensityAt(float millis, float normalizedFrequency, float range, std::size_t level) const {
+        return decibelsAt(millis, normalizedFrequency, level) / range + 1;
     }
 
     // ------------------------------------------------
@@ -0,0 +1,140 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/AudioResampler.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/Float4.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    bool AudioResampler::updateBank() {
+        const bool changed = m_BankIn != sampleRate.in || m_BankOut != sampleRate.out || m_BankQuality != quality;
+        if (!changed && m_Bank) return true;
+
+        auto bank = ResamplerBank::find(sampleRate.in, sampleRate.out, quality);
+        m_BankIn = sampleRate.in;
+        m_BankOut = sampleRate.out;
+        m_BankQuality = quality;
+        if (!bank) {
+            m_Bank = nullptr;
+            return false;
+        }
+
+        // Continue from the input that was already read, starting over with silence would click
+        if (m_Bank) continueFromBank(*bank);
+        else continueFromFallback(*bank);
+
+        m_Bank = std::move(bank);
+        return true;
+    }
+
+    void AudioResampler::continueFromFallback(const ResamplerBank& bank) {
+        const std::size_t phases = bank.phases();
+        const std::int64_t history = static_cast<std::int64_t>(bank.history());
+
+        // The next output of the fallback is at m_InputPos, it becomes the position of the bank. When 
+        // downsampling it can be past the input that was read, then it continues from the last read sample.
+        const std::uint64_t count = m_InputCount;
+        const std::uint64_t fixed = std::min<std::uint64_t>(std::llround(static_cast<double>(m_InputPos) * phases), count * phases);
+        const std::int64_t position = static_cast<std::int64_t>(fixed / phases);
+        m_Phase = static_cast<std::size_t>(fixed % phases);
+
+        // Samples from before the first one that was read wrap around to the silence at the end of the buffer.
+        const std::int64_t first = position - history;
+        m_Count = static_cast<std::size_t>(static_cast<std::int64_t>(count) - first);
+        m_Base = 0;
+        for (std::size_t i = 0; i < m_Count; ++i) {
+            const Stereo& sample = at(static_cast<std::uint64_t>(first + static_cast<std::int64_t>(i)));
+            m_Left[i] = sample.l;
+            m_Right[i] = sample.r;
+        }
+    }
+
+    void AudioResampler::continueFromBank(const ResamplerBank& bank) {
+        // Keep the position of the current output, only the history it needs differs
+        const std::size_t position = m_Base + m_Bank->history();
+        const std::size_t history = bank.history();
+        m_Phase = static_cast<std::size_t>(static_cast<std::uint64_t>(m_Phase) * bank.phases() / m_Bank->phases());
+
+        if (position >= history) {
+            m_Base = position - history; // Dropped by the next reserve
+        } else {
+            const std::size_t missing = history - position;
+            std::copy_backward(m_Left.begin(), m_Left.begin() + m_Count, m_Left.begin() + m_Count + missing);
+            std::copy_backward(m_Right.begin(), m_Right.begin() + m_Count, m_Right.begin() + m_Count + missing);
+            std::fill_n(m_Left.begin(), missing, 0.f);
+            std::fill_n(m_Right.begin(), missing, 0.f);
+            m_Count += missing;
+            m_Base = 0;
+        }
+    }
+
+    // ------------------------------------------------
+
+    std::size_t AudioResampler::reserve(std::size_t& count) {
+        if (m_Base > 0) {
+            std::copy(m_Left.begin() + m_Base, m_Left.begin() + m_Count, m_Left.begin());
+            std::copy(m_Right.begin() + m_Base, m_Right.begin() + m_Count, m_Right.begin());
+            m_Count -= m_Base;
+            m_Base = 0;
+        }
+
+        const std::size_t phases = m_Bank->phases();
+        const std::size_t step = m_Bank->step();
+        const std::size_t taps = m_Bank->taps();
+
+        // Output n starts (m_Phase + n * step) / phases samples after the base
+        const std::size_t fits = ((InputSize - taps) * phases - m_Phase) / step + 1;
+        count = std::min(count, fits);
+
+        const std::size_t last = (m_Phase + (count - 1) * step) / phases + taps;
+        return last > m_Count ? last - m_Count : 0;
+    }
+
+    void AudioResampler::append(std::span<const Stereo> input) {
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            m_Left[m_Count + i] = input[i].l;
+            m_Right[m_Count + i] = input[i].r;
+        }
+
+        m_Count += input.size();
+    }
+
+    void AudioResampler::render(std::span<Stereo> output) {
+        const std::size_t phases = m_Bank->phases();
+        const std::size_t step = m_Bank->step();
+        const std::size_t taps = m_Bank->taps();
+
+        for (auto& sample : output) {
+            const float* coefficients = m_Bank->coefficients(m_Phase);
+            const float* left = m_Left.data() + m_Base;
+            const float* right = m_Right.data() + m_Base;
+
+            // Both channels share the coefficients
+            Float4 sumLeft = Float4::broadcast(0);
+            Float4 sumRight = Float4::broadcast(0);
+            for (std::size_t i = 0; i < taps; i += Float4::Width) {
+                const Float4 coefficient = Float4::load(coefficients + i);
+                sumLeft = sumLeft + coefficient * Float4::load(left + i);
+                sumRight = sumRight + coefficient * Float4::load(right + i);
+            }
+
+            sample = { sumLeft.sum(), sumRight.sum() };
+
+            m_Phase += step;
+            m_Base += m_Phase / phases;
+            m_Phase %= phases;
+        }
+    }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
@@ -23,9 +23,12 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <utility>
 #include "Kaixo/SpectralRotator/Processing/Fft.hpp"
+#include "Kaixo/Utils/Float4.hpp"
+#include "Kaixo/Utils/ParallelFor.hpp"
 
 // ------------------------------------------------
 
@@ -40,6 +43,10 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
+    std::size_t estimateRadix2(std::size_t size, bool inverse);
+
+    // ------------------------------------------------
+
     constexpr size_t reverseBits(size_t val, int width) {
         size_t result = 0;
         for (int i = 0; i < width; i++, val >>= 1)
@@ -47,6 +54,366 @@ namespace Kaixo::Processing {
         return result;
     }
 
+    // ------------------------------------------------
+    //                   FftPlan
+    // ------------------------------------------------
+
+    FftPlan::FftPlan(size_t size, bool inverse)
+        : m_Size(size), m_Inverse(inverse)
+    {
+        // Length variables
+        int levels = 0;  // Compute levels = floor(log2(n))
+        for (size_t temp = size; temp > 1U; temp >>= 1)
+            levels++;
+        if (static_cast<size_t>(1U) << levels != size)
+            throw std::domain_error("Length is not a power of 2");
+        if (size > std::numeric_limits<std::uint32_t>::max())
+            throw std::domain_error("Length is too large");
+
+        // Trigonometric table per stage, computed once in double precision.
+        // The stage with butterflies of half size 'half' starts at offset 'half - 1'.
+        m_TwiddlesReal.resize(size > 1 ? size - 1 : 0);
+        m_TwiddlesImag.resize(size > 1 ? size - 1 : 0);
+        for (size_t half = 1; half < size; half *= 2) {
+            for (size_t k = 0; k < half; k++) {
+                const double angle = (inverse ? 1 : -1) * std::numbers::pi * static_cast<double>(k) / half;
+                m_TwiddlesReal[half - 1 + k] = static_cast<float>(std::cos(angle));
+                m_TwiddlesImag[half - 1 + k] = static_cast<float>(std::sin(angle));
+            }
+        }
+
+        // Bit-reversed addressing permutation
+        m_Permutation.resize(size);
+        for (size_t i = 0; i < size; i++)
+            m_Permutation[i] = static_cast<std::uint32_t>(reverseBits(i, levels));
+    }
+
+    // ------------------------------------------------
+
+    size_t FftPlan::size() const { return m_Size; }
+    bool FftPlan::inverse() const { return m_Inverse; }
+
+    // ------------------------------------------------
+
+    const float* FftPlan::twiddlesReal(size_t half) const { return m_TwiddlesReal.data() + half - 1; }
+    const float* FftPlan::twiddlesImag(size_t half) const { return m_TwiddlesImag.data() + half - 1; }
+
+    // ------------------------------------------------
+
+    const vector<std::uint32_t>& FftPlan::permutation() const { return m_Permutation; }
+
+    // ------------------------------------------------
+    //                 FourStepPlan
+    // ------------------------------------------------
+
+    FourStepPlan::FourStepPlan(size_t size, bool inverse)
+        : m_Size(size), m_Inverse(inverse)
+    {
+        if (size < 4 || (size & (size - 1)) != 0)
+            throw std::domain_error("Length is not a power of 2");
+
+        // Split as evenly as possible, with the rows never longer than the columns
+        const size_t levels = std::countr_zero(size);
+        m_ColumnBits = (levels + 1) / 2;
+        m_Columns = static_cast<size_t>(1) << m_ColumnBits;
+        m_Rows = size >> m_ColumnBits;
+
+        m_RowPlan = FftPlanCache::radix2(m_Columns, inverse);
+        m_ColumnPlan = FftPlanCache::radix2(m_Rows, inverse);
+
+        // The twiddle factor of exponent e = hi * columns + lo is coarse[hi] * fine[lo], 
+        // so 2 small tables cover all of them, computed in double precision.
+        const double sign = inverse ? 1 : -1;
+        m_Coarse.resize(m_Rows);
+        for (size_t hi = 0; hi < m_Rows; hi++)
+            m_Coarse[hi] = complex<float>{ std::polar(1.0, sign * 2 * std::numbers::pi * static_cast<double>(hi) / m_Rows) };
+
+        m_Fine.resize(m_Columns);
+        for (size_t lo = 0; lo < m_Columns; lo++)
+            m_Fine[lo] = complex<float>{ std::polar(1.0, sign * 2 * std::numbers::pi * static_cast<double>(lo) / size) };
+    }
+
+    // ------------------------------------------------
+
+    size_t FourStepPlan::size() const { return m_Size; }
+    bool FourStepPlan::inverse() const { return m_Inverse; }
+
+    // ------------------------------------------------
+
+    size_t FourStepPlan::rows() const { return m_Rows; }
+    size_t FourStepPlan::columns() const { return m_Columns; }
+
+    // ------------------------------------------------
+
+    const FftPlan& FourStepPlan::rowPlan() const { return *m_RowPlan; }
+    const FftPlan& FourStepPlan::columnPlan() const { return *m_ColumnPlan; }
+
+    // ------------------------------------------------
+
+    complex<float> FourStepPlan::twiddle(size_t row, size_t column) const {
+        const size_t exponent = row * column; // Always smaller than the size
+        return m_Coarse[exponent >> m_ColumnBits] * m_Fine[exponent & (m_Columns - 1)];
+    }
+
+    // ------------------------------------------------
+    //                BluesteinPlan
+    // ------------------------------------------------
+
+    BluesteinPlan::BluesteinPlan(size_t size, bool inverse, Fft& fft)
+        : m_Size(size), m_Inverse(inverse)
+    {
+        // Find a power-of-2 convolution length m such that m >= n * 2 + 1
+        size_t n = size;
+        size_t m = std::bit_ceil(n * 2 + 1);
+
+        if (fft.progress) fft.progress->increaseEstimate(estimateRadix2(m, false));
+
+        // Trigonometric table, takes a while for long selections, so it can be canceled halfway
+        m_Chirp.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            if (i % CancelCheckInterval == 0 && fft.shouldStop()) return;
+
+            uintmax_t temp = static_cast<uintmax_t>(i) * i;
+            temp %= static_cast<uintmax_t>(n) * 2;
+            double angle = (inverse ? std::numbers::pi : -std::numbers::pi) * static_cast<double>(temp) / n;
+            m_Chirp[i] = complex<float>{ std::polar(1.0, angle) };
+        }
+
+        // Convolution kernel, transformed once and scaled (because this FFT implementation omits it)
+        m_Kernel.resize(m);
+        m_Kernel[0] = m_Chirp[0];
+        for (size_t i = 1; i < n; i++)
+            m_Kernel[i] = m_Kernel[m - i] = std::conj(m_Chirp[i]);
+
+        fft.transformRadix2(m_Kernel, false);
+        for (auto& value : m_Kernel)
+            value /= static_cast<float>(m);
+    }
+
+    // ------------------------------------------------
+
+    size_t BluesteinPlan::size() const { return m_Size; }
+    bool BluesteinPlan::inverse() const { return m_Inverse; }
+
+    // ------------------------------------------------
+
+    const vector<complex<float>>& BluesteinPlan::chirp() const { return m_Chirp; }
+    const vector<complex<float>>& BluesteinPlan::kernel() const { return m_Kernel; }
+
+    // ------------------------------------------------
+    //                 RealFftPlan
+    // ------------------------------------------------
+
+    RealFftPlan::RealFftPlan(size_t size, bool inverse)
+        : m_Size(size)
+    {
+        if (inverse)
+            throw std::domain_error("Only forward real transforms are supported");
+        if (size < 2 || (size & (size - 1)) != 0)
+            throw std::domain_error("Length is not a power of 2");
+
+        m_Half = FftPlanCache::radix2(size / 2, false);
+
+        // Post-twiddle table, used to separate the even and odd spectra
+        m_Twiddles.resize(size / 2);
+        for (size_t i = 0; i < size / 2; i++) {
+            const double angle = -2 * std::numbers::pi * static_cast<double>(i) / size;
+            m_Twiddles[i] = complex<float>{ std::polar(1.0, angle) };
+        }
+    }
+
+    // ------------------------------------------------
+
+    size_t RealFftPlan::size() const { return m_Size; }
+
+    // ------------------------------------------------
+
+    const vector<complex<float>>& RealFftPlan::twiddles() const { return m_Twiddles; }
+
+    // ------------------------------------------------
+
+    const FftPlan& RealFftPlan::half() const { return *m_Half; }
+
+    // ------------------------------------------------
+    //                 FftPlanCache
+    // ------------------------------------------------
+
+    std::shared_ptr<const FftPlan> FftPlanCache::radix2(size_t size, bool inverse) {
+        auto& self = instance();
+        return self.get(self.m_Radix2, size, inverse, true);
+    }
+
+    std::shared_ptr<const FourStepPlan> FftPlanCache::fourStep(size_t size, bool inverse) {
+        auto& self = instance();
+        return self.get(self.m_FourStep, size, inverse, true);
+    }
+
+    std::shared_ptr<const BluesteinPlan> FftPlanCache::bluestein(size_t size, bool inverse, Fft& fft) {
+        auto& self = instance();
+        const Key key{ size, inverse };
+        if (auto plan = self.find(self.m_Bluestein, key)) return plan;
+
+        // Build outside the lock, large plans take a while to create.
+        auto plan = std::make_shared<const BluesteinPlan>(size, inverse, fft);
+        if (fft.shouldStop()) return plan; // Incomplete kernel, don't keep it around
+
+        return self.insert(self.m_Bluestein, key, std::move(plan), false);
+    }
+
+    std::shared_ptr<const RealFftPlan> FftPlanCache::real(size_t size) {
+        auto& self = instance();
+        return self.get(self.m_Real, size, false, true);
+    }
+
+    template<class Plan>
+    std::shared_ptr<const Plan> FftPlanCache::find(Plans<Plan>& plans, Key key) {
+        std::lock_guard lock{ m_Mutex };
+        if (auto it = plans.retained.find(key); it != plans.retained.end()) return it->second;
+        if (auto it = plans.used.find(key); it != plans.used.end()) return it->second.lock();
+        return nullptr;
+    }
+
+    template<class Plan>
+    std::shared_ptr<const Plan> FftPlanCache::insert(Plans<Plan>& plans, Key key, std::shared_ptr<const Plan> plan, bool retain) {
+        std::lock_guard lock{ m_Mutex };
+        // Only the few small power-of-2 sizes are retained, Bluestein plans
+        // can have any size, retaining those would never stop growing.
+        if (retain && key.first <= MaxRetainedSize) {
+            return plans.retained.try_emplace(key, std::move(plan)).first->second;
+        }
+
+        std::erase_if(plans.used, [](const auto& entry) { return entry.second.expired(); });
+        auto& slot = plans.used[key];
+        if (auto existing = slot.lock()) plan = existing; // Created by another thread in the meantime
+        else slot = plan;
+
+        return plan;
+    }
+
+    template<class Plan>
+    std::shared_ptr<const Plan> FftPlanCache::get(Plans<Plan>& plans, size_t size, bool inverse, bool retain) {
+        const Key key{ size, inverse };
+        if (auto plan = find(plans, key)) return plan;
+
+        // Build outside the lock, large plans take a while to create.
+        return insert(plans, key, std::make_shared<const Plan>(size, inverse), retain);
+    }
+
+    FftPlanCache& FftPlanCache::instance() {
+        static FftPlanCache cache{};
+        return cache;
+    }
+
+    // ------------------------------------------------
+    //                   Kernels
+    // ------------------------------------------------
+
+    // Scalar counterpart of Float4, so the butterflies only have to be written once.
+    struct Float1 {
+        float value;
+
+        static Float1 load(const float* ptr) { return { *ptr }; }
+        void store(float* ptr) const { *ptr = value; }
+
+        friend Float1 operator+(Float1 a, Float1 b) { return { a.value + b.value }; }
+        friend Float1 operator-(Float1 a, Float1 b) { return { a.value - b.value }; }
+        friend Float1 operator*(Float1 a, Float1 b) { return { a.value * b.value }; }
+    };
+
+    // ------------------------------------------------
+
+    template<class V>
+    void multiply(V ar, V ai, V br, V bi, V& outr, V& outi) {
+        outr = ar * br - ai * bi;
+        outi = ar * bi + ai * br;
+    }
+
+    // Butterflies at index k of a single radix-2 stage.
+    template<class V>
+    void radix2Butterflies(float* re, float* im, size_t half, const float* wr, const float* wi, size_t k) {
+        V ar = V::load(re + k), ai = V::load(im + k);
+        V br = V::load(re + k + half), bi = V::load(im + k + half);
+
+        V tr, ti;
+        multiply(br, bi, V::load(wr + k), V::load(wi + k), tr, ti);
+
+        (ar + tr).store(re + k);
+        (ai + ti).store(im + k);
+        (ar - tr).store(re + k + half);
+        (ai - ti).store(im + k + half);
+    }
+
+    // Butterflies at index k of the 2 consecutive stages 'half' and '2 * half', done in a single pass.
+    template<class V>
+    void radix4Butterflies(float* re, float* im, size_t half,
+        const float* war, const float* wai, const float* wbr, const float* wbi, size_t k)
+    {
+        V x0r = V::load(re + k),            x0i = V::load(im + k);
+        V x1r = V::load(re + k + half),     x1i = V::load(im + k + half);
+        V x2r = V::load(re + k + 2 * half), x2i = V::load(im + k + 2 * half);
+        V x3r = V::load(re + k + 3 * half), x3i = V::load(im + k + 3 * half);
+
+        V ar = V::load(war + k),        ai = V::load(wai + k);
+        V br = V::load(wbr + k),        bi = V::load(wbi + k);
+        V cr = V::load(wbr + k + half), ci = V::load(wbi + k + half);
+
+        V tr, ti;
+
+        // First stage, butterflies with distance 'half'
+        multiply(x1r, x1i, ar, ai, tr, ti);
+        V y0r = x0r + tr, y0i = x0i + ti;
+        V y1r = x0r - tr, y1i = x0i - ti;
+
+        multiply(x3r, x3i, ar, ai, tr, ti);
+        V y2r = x2r + tr, y2i = x2i + ti;
+        V y3r = x2r - tr, y3i = x2i - ti;
+
+        // Second stage, butterflies with distance '2 * half'
+        multiply(y2r, y2i, br, bi, tr, ti);
+        (y0r + tr).store(re + k);
+        (y0i + ti).store(im + k);
+        (y0r - tr).store(re + k + 2 * half);
+        (y0i - ti).store(im + k + 2 * half);
+
+        multiply(y3r, y3i, cr, ci, tr, ti);
+        (y1r + tr).store(re + k + half);
+        (y1i + ti).store(im + k + half);
+        (y1r - tr).store(re + k + 3 * half);
+        (y1i - ti).store(im + k + 3 * half);
+    }
+
+    // ------------------------------------------------
+
+    void radix2Pass(float* re, float* im, size_t n, size_t half, const FftPlan& plan) {
+        const float* wr = plan.twiddlesReal(half);
+        const float* wi = plan.twiddlesImag(half);
+
+        for (size_t base = 0; base < n; base += 2 * half) {
+            size_t k = 0;
+            for (; k + Float4::Width <= half; k += Float4::Width)
+                radix2Butterflies<Float4>(re + base, im + base, half, wr, wi, k);
+            for (; k < half; k++)
+                radix2Butterflies<Float1>(re + base, im + base, half, wr, wi, k);
+        }
+    }
+
+    void radix4Pass(float* re, float* im, size_t n, size_t half, const FftPlan& plan) {
+        const float* war = plan.twiddlesReal(half);
+        const float* wai = plan.twiddlesImag(half);
+        const float* wbr = plan.twiddlesReal(2 * half);
+        const float* wbi = plan.twiddlesImag(2 * half);
+
+        for (size_t base = 0; base < n; base += 4 * half) {
+            size_t k = 0;
+            for (; k + Float4::Width <= half; k += Float4::Width)
+                radix4Butterflies<Float4>(re + base, im + base, half, war, wai, wbr, wbi, k);
+            for (; k < half; k++)
+                radix4Butterflies<Float1>(re + base, im + base, half, war, wai, wbr, wbi, k);
+        }
+    }
+
+    // ------------------------------------------------
+    //                     Fft
     // ------------------------------------------------
 
     void Fft::transform(vector<complex<float> >& vec, bool inverse) {
@@ -59,101 +426,219 @@ namespace Kaixo::Processing {
             transformBluestein(vec, inverse);
     }
 
-    // ------------------------------------------------
-
-    void Fft::transformRadix2(vector<complex<float> >& vec, bool inverse) {
-        // Length variables
+    void Fft::transform(const FftPlan& plan, vector<complex<float> >& vec) {
         size_t n = vec.size();
-        int levels = 0;  // Compute levels = floor(log2(n))
-        for (size_t temp = n; temp > 1U; temp >>= 1)
-            levels++;
-        if (static_cast<size_t>(1U) << levels != n)
-            throw std::domain_error("Length is not a power of 2");
+        if (n != plan.size())
+            throw std::domain_error("Mismatched lengths");
+
+        // Bit-reversed addressing permutation, while splitting into real and imaginary parts
+        m_Real.resize(n);
+        m_Imag.resize(n);
+        float* re = m_Real.data();
+        float* im = m_Imag.data();
 
-        // Trigonometric table
-        vector<complex<float> > expTable(n / 2);
-        for (size_t i = 0; i < n / 2; i++) {
-            expTable[i] = std::polar(1.0f, (inverse ? 2 : -2) * (std::numbers::pi_v<float>) * i / n);
+        const auto& permutation = plan.permutation();
+        for (size_t i = 0; i < n; i++) {
+            const complex<float> value = vec[permutation[i]];
+            re[i] = value.real();
+            im[i] = value.imag();
+        }
+
+        step(n / 2);
+        if (shouldStop()) return;
+
+        // Cooley-Tukey decimation-in-time, doing 2 radix-2 stages per radix-4 pass.
+        // For an odd number of stages, the first one is done as a plain radix-2 pass.
+        size_t half = 1;
+        if (std::countr_zero(n) % 2 == 1) {
+            radix2Pass(re, im, n, half, plan);
+            half *= 2;
 
-            step();
+            step(n / 2);
             if (shouldStop()) return;
         }
 
-        // Bit-reversed addressing permutation
-        for (size_t i = 0; i < n; i++) {
-            size_t j = reverseBits(i, levels);
-            if (j > i)
-                std::swap(vec[i], vec[j]);
+        for (; half * 4 <= n; half *= 4) {
+            radix4Pass(re, im, n, half, plan);
 
-            step();
+            step(n);
             if (shouldStop()) return;
         }
 
-        // Cooley-Tukey decimation-in-time radix-2 FFT
-        for (size_t size = 2; size <= n; size *= 2) {
-            size_t halfsize = size / 2;
-            size_t tablestep = n / size;
-            for (size_t i = 0; i < n; i += size) {
-                for (size_t j = i, k = 0; j < i + halfsize; j++, k += tablestep) {
-                    complex<float> temp = vec[j + halfsize] * expTable[k];
-                    vec[j + halfsize] = vec[j] - temp;
-                    vec[j] += temp;
-
-                    step();
-                    if (shouldStop()) return;
-                }
-            }
-            if (size == n)  // Prevent overflow in 'size *= 2'
-                break;
+        for (size_t i = 0; i < n; i++)
+            vec[i] = { re[i], im[i] };
+    }
+
+    // ------------------------------------------------
+
+    void Fft::transformRadix2(vector<complex<float> >& vec, bool inverse) {
+        if (parallel && vec.size() >= FourStepSize) {
+            transformFourStep(*FftPlanCache::fourStep(vec.size(), inverse), vec);
+        } else {
+            transform(*FftPlanCache::radix2(vec.size(), inverse), vec);
         }
     }
 
     // ------------------------------------------------
 
-    void Fft::transformBluestein(vector<complex<float> >& vec, bool inverse) {
-        // Find a power-of-2 convolution length m such that m >= n * 2 + 1
+    void Fft::transformFourStep(const FourStepPlan& plan, vector<complex<float> >& vec) {
         size_t n = vec.size();
-        size_t m = std::bit_ceil(n * 2 + 1);
+        if (n != plan.size())
+            throw std::domain_error("Mismatched lengths");
 
-        // Trigonometric table
-        vector<complex<float> > expTable(n);
-        for (size_t i = 0; i < n; i++) {
-            uintmax_t temp = static_cast<uintmax_t>(i) * i;
-            temp %= static_cast<uintmax_t>(n) * 2;
-            float angle = (inverse ? (std::numbers::pi_v<float>) : -(std::numbers::pi_v<float>)) * temp / n;
-            expTable[i] = std::polar(1.0f, angle);
+        const size_t rows = plan.rows();
+        const size_t columns = plan.columns();
+
+        // Lines are processed in blocks of 8, so a whole cache line gets used 
+        // when gathering the strided elements of a line.
+        constexpr size_t Block = 8;
+
+        // Runs 'pass' on every block of lines, every task with its own Fft and buffers.
+        auto forEachBlock = [&](size_t lines, size_t length, auto pass) {
+            auto task = [&](size_t block) {
+                if (shouldStop()) return;
+
+                Fft fft{};
+                fft.progress = progress;
+                fft.cancelation = cancelation;
+
+                const size_t first = block * Block;
+                vector<vector<complex<float> > > buffers(std::min(Block, lines - first), vector<complex<float> >(length));
+                pass(fft, first, buffers);
+            };
+
+            const size_t blocks = (lines + Block - 1) / Block;
+            if (parallel) {
+                parallelFor(priority, blocks, task);
+            } else {
+                for (size_t block = 0; block < blocks; block++)
+                    task(block);
+            }
+        };
 
-            step();
-            if (shouldStop()) return;
-        }
+        // Element (row, column) of the input is vec[row + rows * column]
+        vector<complex<float> > matrix(n);
+
+        // FFT over every row, and multiply by the twiddle factors
+        forEachBlock(rows, columns, [&](Fft& fft, size_t first, auto& buffers) {
+            for (size_t column = 0; column < columns; column++)
+                for (size_t j = 0; j < buffers.size(); j++)
+                    buffers[j][column] = vec[first + j + rows * column];
+
+            for (size_t j = 0; j < buffers.size(); j++) {
+                fft.transform(plan.rowPlan(), buffers[j]);
+                if (fft.shouldStop()) return;
+
+                const size_t row = first + j;
+                complex<float>* out = matrix.data() + row * columns;
+                for (size_t column = 0; column < columns; column++)
+                    out[column] = buffers[j][column] * plan.twiddle(row, column);
+            }
+        });
+
+        if (shouldStop()) return;
+
+        // FFT over every column, element (row, column) of the output is vec[column + columns * row]
+        forEachBlock(columns, rows, [&](Fft& fft, size_t first, auto& buffers) {
+            for (size_t row = 0; row < rows; row++)
+                for (size_t j = 0; j < buffers.size(); j++)
+                    buffers[j][row] = matrix[row * columns + first + j];
+
+            for (size_t j = 0; j < buffers.size(); j++) {
+                fft.transform(plan.columnPlan(), buffers[j]);
+                if (fft.shouldStop()) return;
+            }
+
+            for (size_t row = 0; row < rows; row++)
+                for (size_t j = 0; j < buffers.size(); j++)
+                    vec[first + j + columns * row] = buffers[j][row];
+        });
+    }
+
+    // ------------------------------------------------
+
+    void Fft::prepare(size_t n, bool inverse) {
+        // Radix-2 plans are cheap to create, the Bluestein plan is kept alive by this Fft
+        // and its copies, so it's released once the transforms using it are done.
+        if (n != 0 && (n & (n - 1)) != 0)
+            m_Prepared = FftPlanCache::bluestein(n, inverse, *this);
+    }
+
+    // ------------------------------------------------
 
-        // Temporary vectors and preprocessing
+    void Fft::transformBluestein(vector<complex<float> >& vec, bool inverse) {
+        size_t n = vec.size();
+        auto plan = m_Prepared && m_Prepared->size() == n && m_Prepared->inverse() == inverse
+            ? m_Prepared : FftPlanCache::bluestein(n, inverse, *this);
+        if (shouldStop()) return;
+
+        const auto& expTable = plan->chirp();
+        const auto& kernel = plan->kernel();
+        size_t m = kernel.size();
+
+        // Temporary vector and preprocessing
         vector<complex<float> > avec(m);
-        for (size_t i = 0; i < n; i++) {
+        for (size_t i = 0; i < n; i++)
             avec[i] = vec[i] * expTable[i];
 
-            step();
-            if (shouldStop()) return;
-        }
-        vector<complex<float> > bvec(m);
-        bvec[0] = expTable[0];
-        for (size_t i = 1; i < n; i++) {
-            bvec[i] = bvec[m - i] = std::conj(expTable[i]);
+        step(n);
+        if (shouldStop()) return;
 
-            step();
-            if (shouldStop()) return;
-        }
+        // Convolution with the precomputed kernel spectrum
+        transformRadix2(avec, false);
+        if (shouldStop()) return;
 
-        // Convolution
-        vector<complex<float> > cvec = convolve(std::move(avec), std::move(bvec));
+        for (size_t i = 0; i < m; i++)
+            avec[i] *= kernel[i];
+
+        transformRadix2(avec, true);
+        if (shouldStop()) return;
 
         // Postprocessing
-        for (size_t i = 0; i < n; i++) {
-            vec[i] = cvec[i] * expTable[i];
+        for (size_t i = 0; i < n; i++)
+            vec[i] = avec[i] * expTable[i];
 
-            step();
-            if (shouldStop()) return;
+        step(n);
+    }
+
+    // ------------------------------------------------
+
+    void Fft::transformReal(const RealFftPlan& plan, const vector<float>& input, vector<complex<float> >& output) {
+        size_t n = input.size();
+        if (n != plan.size())
+            throw std::domain_error("Mismatched lengths");
+
+        // Pack even samples into the real, and odd samples into the imaginary part
+        size_t half = n / 2;
+        output.reserve(half + 1);
+        output.resize(half);
+        for (size_t i = 0; i < half; i++)
+            output[i] = { input[2 * i], input[2 * i + 1] };
+
+        transform(plan.half(), output);
+        if (shouldStop()) return;
+
+        output.resize(half + 1);
+
+        // Separate the spectra of the even and odd samples, and combine them
+        const auto& twiddles = plan.twiddles();
+        const complex<float> z0 = output[0];
+        output[0] = { z0.real() + z0.imag(), 0 };
+        output[half] = { z0.real() - z0.imag(), 0 };
+        for (size_t k = 1, j = half - 1; k <= j; k++, j--) {
+            const complex<float> a = output[k];
+            const complex<float> b = output[j];
+
+            const complex<float> evenK = 0.5f * (a + std::conj(b));
+            const complex<float> oddK = complex<float>{ 0, -0.5f } * (a - std::conj(b));
+            const complex<float> evenJ = 0.5f * (b + std::conj(a));
+            const complex<float> oddJ = complex<float>{ 0, -0.5f } * (b - std::conj(a));
+
+            output[k] = evenK + twiddles[k] * oddK;
+            output[j] = evenJ + twiddles[j] * oddJ;
         }
+
+        step(half / 2);
     }
 
     // ------------------------------------------------
@@ -178,7 +663,6 @@ namespace Kaixo::Processing {
     // ------------------------------------------------
 
     std::size_t estimateBluestein(std::size_t size, bool inverse);
-    std::size_t estimateRadix2(std::size_t size, bool inverse);
     std::size_t estimateFft(std::size_t n, bool inverse) {
         if (n == 0) return 0;
         else if ((n & (n - 1)) == 0) return estimateRadix2(n, inverse);
@@ -186,39 +670,31 @@ namespace Kaixo::Processing {
     }
 
     std::size_t estimateRadix2(std::size_t n, bool /*inverse*/) {
-        std::size_t steps = 0;
-        for (size_t size = 2; size <= n; size *= 2) {
-            size_t halfsize = size / 2;
-            size_t tablestep = n / size;
-            for (size_t i = 0; i < n; i += size) {
-                for (size_t j = i, k = 0; j < i + halfsize; j++, k += tablestep) {
-                    steps++;
-                }
-            }
-            if (size == n)  // Prevent overflow in 'size *= 2'
-                break;
-        }
-        return n / 2 + // Trigonometry table
-            n +        // Bit reverse
-            steps; // Cooley-Tukey
+        std::size_t levels = std::countr_zero(n);
+        return n / 2 + // Bit reverse
+            n / 2 * levels; // Cooley-Tukey, n / 2 butterflies per stage
     }
     
     std::size_t estimateBluestein(std::size_t n, bool inverse) {
         std::size_t m = std::bit_ceil(n * 2 + 1);
 
-        return n + // Trig table
-            n + n - 1 + // Preprocessing
+        return n + // Preprocessing
             n + // Postprocessing
-            estimateRadix2(m, inverse) * 3; // in the convolve
+            estimateRadix2(m, inverse) * 2; // Convolution, kernel spectrum is cached in the plan
     }
 
     std::size_t Fft::estimateSteps(std::size_t n, bool inverse) {
         return estimateFft(n, inverse);
     }
 
+    std::size_t Fft::estimateRealSteps(std::size_t n) {
+        return estimateRadix2(n / 2, false) + // Half size complex FFT
+            n / 4; // Post-processing
+    }
+
     // ------------------------------------------------
 
-    void Fft::step() { if (progress) progress->step(); }
+    void Fft::step(std::int64_t amount) { if (progress) progress->step(amount); }
     bool Fft::shouldStop() { return cancelation ? cancelation->load() : false; }
 
     // ------------------------------------------------
@@ -19,6 +19,10 @@
 
 // ------------------------------------------------
 
+#include "Kaixo/Utils/ParallelFor.hpp"
+
+// ------------------------------------------------
+
 namespace Kaixo::Processing {
 
     // ------------------------------------------------
@@ -33,6 +37,7 @@ namespace Kaixo::Processing {
         m_AnalyzerCanceled = true;
         m_TransformCanceled = true;
         m_LoadCanceled = true;
+        cancelPrecompute();
     }
 
     // ------------------------------------------------
@@ -42,6 +47,10 @@ namespace Kaixo::Processing {
         output = player.output;
     }
 
+    void FileHandler::processBlock(std::span<Stereo> block) {
+        player.processBlock(block);
+    }
+
     // ------------------------------------------------
 
     void FileHandler::clearSession() {
@@ -49,15 +58,14 @@ namespace Kaixo::Processing {
 
         KAIXO_DEBUG("Clearing the session.");
 
+        cancelPrecompute();
+
         m_InSession = false;
         m_Cache.invalidate();
 
-        buffer.access([&](juce::AudioBuffer<float>& bfr, float& sampleRate, std::int64_t& start) {
-            start = 0;
-            bfr.setSize(0, 0);
-            sampleRate = 0;
-        });
+        buffer.publish({}, 0, 0);
 
+        updatePeaks();
         notifyStateChanged();
     }
 
@@ -138,8 +146,9 @@ namespace Kaixo::Processing {
         // Cancel all other activities on a load.
         m_TransformCanceled = true;
         m_AnalyzerCanceled = true;
+        cancelPrecompute();
 
-        return m_ActivityWorker.push([this, path, settings] {
+        return m_Jobs.push(TaskAccess::Write, TaskPriority::IO, [this, path, settings] {
             std::lock_guard lock{ m_Mutex };
 
             KAIXO_DEBUG("Loading file from path '{}'", Convert::pathToString(path));
@@ -170,36 +179,42 @@ namespace Kaixo::Processing {
                 readFromAudioFile = false;
             }
 
-            buffer.access([&](juce::AudioBuffer<float>& bfr, float& sampleRate, std::int64_t& start) {
-                // Sample rate changed mid-session, adjust the selection accordingly
-				if (m_InSession && sampleRate != fileSampleRate) {
-                    selection.size = static_cast<std::int64_t>(newBuffer.getNumSamples() * fileSampleRate / sampleRate);
-                }
+            // Sample rate changed mid-session, adjust the selection accordingly
+            const float previousSampleRate = buffer.sampleRate();
+            if (m_InSession && previousSampleRate != fileSampleRate) {
+                selection.size = static_cast<std::int64_t>(newBuffer.getNumSamples() * fileSampleRate / previousSampleRate);
+            }
 
-                start = 0;
-                sampleRate = fileSampleRate;
-                bfr = std::move(newBuffer);
-
-                // Assume new imported file was from previous export, 
-                // so start of the file is the start of our selection.
-                selection.start = 0;
-                selection.size = Math::min(selection.size, bfr.getNumSamples());
-                m_IdentityBufferOffset = 0;
-                m_TimelineLength = bfr.getNumSamples();
-
-                if (!m_InSession) { // Start new session by selecting the whole buffer.
-                    KAIXO_DEBUG("Starting a new session.");
-                    selection = { 0, bfr.getNumSamples() };
-                    m_InSession = true;
-                }
+            // Assume new imported file was from previous export, 
+            // so start of the file is the start of our selection.
+            selection.start = 0;
+            selection.size = Math::min(selection.size, newBuffer.getNumSamples());
+            m_IdentityBufferOffset = 0;
+            m_TimelineLength = newBuffer.getNumSamples();
+
+            if (!m_InSession) { // Start new session by selecting the whole buffer.
+                KAIXO_DEBUG("Starting a new session.");
+                selection = { 0, newBuffer.getNumSamples() };
+                m_InSession = true;
+            }
 
-                m_Cache.invalidate();
-                // new buffer is the new identity, as all new rotations will go from here.
-                m_Cache.store(Transform::Identity, bfr);
-                m_CurrentTransform = Transform::Identity;
-            });
+            m_Cache.invalidate();
+            if (auto budget = Config::UserSettings["cache-budget"].get<float>()) {
+                m_Cache.budget(static_cast<std::size_t>(*budget * 1024 * 1024)); // In megabytes
+            }
 
-            performNormalize(m_LoadProgress, m_LoadCanceled);
+            // new buffer is the new identity, as all new rotations will go from here.
+            auto identity = std::make_shared<const juce::AudioBuffer<float>>(std::move(newBuffer));
+            m_Cache.store(Transform::Identity, identity);
+            m_CurrentTransform = Transform::Identity;
+
+            // The published buffer is a normalized view on the identity, so it's not copied
+            SafeAudioBuffer::View view = SafeAudioBuffer::View::whole(*identity);
+            performNormalize(view, *identity, m_LoadProgress, m_LoadCanceled);
+
+            // Build the resampling filters now, so playback doesn't start with the fallback
+            ResamplerBank::prepare(fileSampleRate, player.sampleRate(), player.quality());
+            buffer.publish(std::move(identity), view, fileSampleRate, 0);
 
             if (readFromAudioFile) {
                 // Only use original file path as saved file if it was an audio file.
@@ -212,8 +227,12 @@ namespace Kaixo::Processing {
 
             m_OriginalFileName = Convert::pathToString(path.stem());
 
+            updatePeaks();
             notifyStateChanged();
 
+            // Most likely the first transform will be a rotation
+            precompute();
+
             return FileLoadResult::Success;
         });
     }
@@ -224,8 +243,9 @@ namespace Kaixo::Processing {
         @returns the path to the file containing the current audio buffer.
      */
     std::future<std::filesystem::path> FileHandler::save() {
-        return m_ActivityWorker.push([this] {
-            std::lock_guard lock{ m_Mutex };
+        return m_Jobs.push(TaskAccess::Read, TaskPriority::IO, [this] {
+            std::shared_lock lock{ m_Mutex };
+            std::lock_guard saveLock{ m_SaveMutex }; // Saves update m_SavedFile
 
             KAIXO_DEBUG("Saving current buffer to file.");
 
@@ -274,11 +294,12 @@ namespace Kaixo::Processing {
                 return std::filesystem::path{};
             }
 
-            juce::AudioBuffer<float> audio{};
-            auto sampleRate = buffer.sampleRate();
-            buffer.access([&](juce::AudioBuffer<float>& bfr, float&, std::int64_t&) {
-                audio = bfr;
-            });
+            // The snapshot never changes, so it's written directly, a view 
+            // on a buffer is only turned into a buffer of its own here.
+            auto snapshot = buffer.snapshot();
+            const auto materialized = snapshot->materialize();
+            const juce::AudioBuffer<float>& audio = *materialized;
+            const float sampleRate = snapshot->sampleRate;
 
             juce::WavAudioFormat wavFormat{};
             std::unique_ptr<juce::AudioFormatWriter> writer{
@@ -311,8 +332,9 @@ namespace Kaixo::Processing {
 
         m_TransformCanceled = false;
         m_AnalyzerCanceled = true; // Stop any analyzing
+        cancelPrecompute(); // Its result is used when it finished for this selection
 
-        return m_ActivityWorker.push([this, t, select = selection] mutable {
+        return m_Jobs.push(TaskAccess::Write, TaskPriority::Background, [this, t, select = selection] mutable {
             std::lock_guard lock{ m_Mutex };
 
             auto _ = m_TransformProgress.scoped();
@@ -342,10 +364,9 @@ namespace Kaixo::Processing {
                     m_Cache.invalidate();
                     m_LoadedFile.clear(); // No longer from a loaded file.
                     
-                    m_IdentityBufferOffset = buffer.startOffset.load();
-                    buffer.access([&](juce::AudioBuffer<float>& bfr, float&, std::int64_t&) {
-                        m_Cache.store(Transform::Identity, bfr);
-                    });
+                    auto snapshot = buffer.snapshot();
+                    m_IdentityBufferOffset = snapshot->startOffset;
+                    m_Cache.store(Transform::Identity, snapshot->materialize());
                 }
             }
 
@@ -367,42 +388,117 @@ namespace Kaixo::Processing {
             case Transform::Mirror270: startFromFft = true; ops = TransformOperation::Flip | TransformOperation::Reverse; break;
             }
 
+            std::shared_ptr<const juce::AudioBuffer<float>> source{};
+            SafeAudioBuffer::View view{};
             if (startFromFft) {
                 KAIXO_DEBUG("Transform requires an FFT. Using Mirror90 from cache as a starting point.");
 
                 if (!m_Cache.contains(Transform::Mirror90)) {
-                    KAIXO_DEBUG("Cache does not contain Mirror90, generation it and adding it to cache.");
-                    performFft({ select.start - m_IdentityBufferOffset, select.size }, m_Cache.get(Transform::Identity));
+                    auto mirror = takePrecomputed(select);
+                    if (!mirror) {
+                        KAIXO_DEBUG("Cache does not contain Mirror90, generation it and adding it to cache.");
+                        mirror = performFft({ select.start - m_IdentityBufferOffset, select.size }, *m_Cache.get(Transform::Identity),
+                            TaskPriority::Background, m_TransformProgress, m_TransformCanceled);
+                    }
+
+                    if (mirror) m_Cache.store(Transform::Mirror90, std::move(mirror));
                 }
 
-                performTransform(Transform::Mirror90, ops, { 0, select.size }, m_Cache.get(Transform::Mirror90));
+                source = m_Cache.get(Transform::Mirror90);
+                view = performTransform(Transform::Mirror90, ops, { 0, select.size }, *source);
             } else {
-                performTransform(Transform::Identity, ops, { select.start - m_IdentityBufferOffset, select.size }, m_Cache.get(Transform::Identity));
+                source = m_Cache.get(Transform::Identity);
+                view = performTransform(Transform::Identity, ops, { select.start - m_IdentityBufferOffset, select.size }, *source);
             }
 
-            performNormalize(m_TransformProgress, m_TransformCanceled);
-            if (m_CurrentTransform == Transform::Identity) {
-                buffer.startOffset = m_IdentityBufferOffset.load();
-            } else {
-                buffer.startOffset = select.start;
+            performNormalize(view, *source, m_TransformProgress, m_TransformCanceled);
+
+            // Published all at once, playback switches from the old to the new buffer between two 
+            // reads. A canceled transform is only partially done, so it leaves the buffer as it was.
+            if (!m_TransformCanceled) {
+                const std::int64_t startOffset = m_CurrentTransform == Transform::Identity ? m_IdentityBufferOffset.load() : select.start;
+                buffer.publish(std::move(source), view, buffer.sampleRate(), startOffset);
             }
 
             selection = select;
 
+            updatePeaks();
             notifyStateChanged();
         });
     }
 
+    void FileHandler::precompute() {
+        const Selection select = selection;
+        const std::size_t version = buffer.version();
+        auto canceled = std::make_shared<std::atomic_bool>(false);
+
+        {
+            std::lock_guard lock{ m_PrecomputeTagMutex };
+            if (m_PrecomputeSelection == select && m_PrecomputeVersion == version && (!*m_PrecomputeCanceled || m_Precomputed)) {
+                return; // Already precomputing, or precomputed, this
+            }
+
+            *m_PrecomputeCanceled = true;
+            m_PrecomputeCanceled = canceled;
+            m_PrecomputeSelection = select;
+            m_PrecomputeVersion = version;
+            m_Precomputed = nullptr;
+        }
+
+        KAIXO_DEBUG("Added precompute of selection [{}, {}] to activity queue.", select.start, select.size);
+
+        // Not part of the job queue, so a load or transform never waits for it to be started. It
+        // only reads the cache, the result is handed off to the transform that writes it to the cache.
+        m_PrecomputeLane.push(TaskPriority::Idle, [this, select, version, canceled] {
+            std::shared_lock lock{ m_Mutex };
+
+            if (*canceled || buffer.version() != version) return; // Stale
+            if (!m_InSession || !m_Cache.contains(Transform::Identity)) return;
+
+            // A transform of a new selection starts a new session from the current buffer,
+            // unless it's the identity, so only then is the FFT known in advance.
+            if (m_CachedSelection != select && m_CurrentTransform != Transform::Identity) return;
+            if (m_CachedSelection == select && m_Cache.contains(Transform::Mirror90)) return;
+
+            KAIXO_DEBUG("Precomputing Mirror90 for selection [{}, {}].", select.start, select.size);
+
+            auto _ = m_PrecomputeProgress.scoped();
+            auto mirror = performFft({ select.start - m_IdentityBufferOffset, select.size }, *m_Cache.get(Transform::Identity),
+                TaskPriority::Idle, m_PrecomputeProgress, *canceled);
+            if (!mirror) return;
+
+            std::lock_guard tagLock{ m_PrecomputeTagMutex };
+            if (!*canceled) m_Precomputed = std::move(mirror); // Otherwise replaced by another job
+        });
+    }
+
+    bool FileHandler::cancelPrecompute() {
+        std::lock_guard lock{ m_PrecomputeTagMutex };
+        const bool unfinished = !*m_PrecomputeCanceled && !m_Precomputed;
+        *m_PrecomputeCanceled = true;
+        return unfinished;
+    }
+
+    std::shared_ptr<const juce::AudioBuffer<float>> FileHandler::takePrecomputed(Selection select) {
+        std::lock_guard lock{ m_PrecomputeTagMutex };
+        if (m_PrecomputeSelection != select || m_PrecomputeVersion != buffer.version()) return nullptr;
+        return std::exchange(m_Precomputed, nullptr);
+    }
+
     // ------------------------------------------------
     
-    std::future<AnalyzeResult> FileHandler::analyze(AnalyzeSettings settings) {
+    std::future<std::shared_ptr<const AnalyzeResult>> FileHandler::analyze(AnalyzeSettings settings, AnalyzeRange range) {
         m_AnalyzerCanceled = false;
 
-        return m_ActivityWorker.push([this, settings] {
+        // The speculative FFT would hold up the analysis, it's resumed afterwards if the selection didn't change
+        const bool resumePrecompute = cancelPrecompute();
+
+        return m_Jobs.push(TaskAccess::Read, TaskPriority::Background, [this, settings, range, resumePrecompute, select = selection]() -> std::shared_ptr<const AnalyzeResult> {
 
             // ------------------------------------------------
 
-            std::lock_guard lock{ m_Mutex };
+            std::shared_lock lock{ m_Mutex };
+            std::lock_guard analyzeLock{ m_AnalyzeMutex }; // Analyses share the spectrogram cache
 
             // ------------------------------------------------
 
@@ -410,24 +506,93 @@ namespace Kaixo::Processing {
 
             // ------------------------------------------------
 
-            const float sampleRate = buffer.sampleRate();
+            // Everything is analyzed from the same snapshot of the buffer
+            auto snapshot = buffer.snapshot();
+            const SafeAudioBuffer::ReadBuffer input = snapshot.read();
+
+            // Zoomed out, only the blocks that can be shown are analyzed
+            const std::int64_t stride = AnalyzeResult::stride(settings, range.pixel);
+            const float resolution = settings.fftResolution * stride;
+
+            const float sampleRate = input.sampleRate();
             const std::int64_t fftLatencyAdjust = settings.fftSize / 2;
-            const std::int64_t size = buffer.size() + fftLatencyAdjust;
+            const std::int64_t size = input.size() + fftLatencyAdjust;
             const std::int64_t blockSize = static_cast<std::int64_t>(settings.fftSize);
-            const float distanceBetweenBlocks = Math::max(Convert::millisToSamples(settings.fftResolution, sampleRate).value, 1);
+            const float distanceBetweenBlocks = Math::max(Convert::millisToSamples(resolution, sampleRate).value, 1);
             const std::int64_t blocks = static_cast<std::int64_t>(Math::ceil(size / distanceBetweenBlocks));
             const std::int64_t frequencyBins = settings.fftSize / 2 + 1;
 
             // ------------------------------------------------
 
-            std::vector<std::complex<float>> fftBuffer(settings.fftSize);
+            // Window is the same for every block
+            std::vector<float> window(blockSize);
+            float windowScaleAdjustment = 0;
+            for (std::int64_t sampleInBlock = 0; sampleInBlock < blockSize; ++sampleInBlock) {
+                window[sampleInBlock] = 0.5f * (1.0f - Math::Fast::ncos(static_cast<float>(sampleInBlock) / (blockSize - 1)));
+                windowScaleAdjustment += window[sampleInBlock];
+            }
+
+            // ------------------------------------------------
+
+            // Tiles are only valid for the buffer they were analyzed from
+            m_Spectrograms.invalidate(m_StateCounter);
+
+            auto result = std::make_shared<AnalyzeResult>(settings, sampleRate, blocks, frequencyBins, stride);
+
+            // Besides the visible range, prefetch a margin, mostly in the direction we're panning in
+            const float width = Math::max(range.end - range.start, resolution);
+            const float marginBefore = width * (range.direction < 0 ? 1.f : range.direction > 0 ? 0.25f : 0.5f);
+            const float marginAfter = width * (range.direction > 0 ? 1.f : range.direction < 0 ? 0.25f : 0.5f);
+
+            auto tileOf = [&](float millis) {
+                const std::int64_t block = static_cast<std::int64_t>(millis / resolution);
+                return std::clamp<std::int64_t>(block / AnalyzeResult::TileBlocks, 0, std::max<std::int64_t>(result->tiles() - 1, 0));
+            };
+
+            const std::int64_t firstVisibleTile = tileOf(range.start);
+            const std::int64_t lastVisibleTile = tileOf(range.end);
+            const std::int64_t firstTile = tileOf(range.start - marginBefore);
+            const std::int64_t lastTile = tileOf(range.end + marginAfter);
+
+            std::vector<std::shared_ptr<SpectrogramTile>> tiles;
+            for (std::int64_t index = firstTile; index <= lastTile && index < result->tiles(); ++index) {
+                const std::int64_t firstBlock = index * AnalyzeResult::TileBlocks;
+                const std::size_t tileBlocks = static_cast<std::size_t>(Math::min(AnalyzeResult::TileBlocks, blocks - firstBlock));
+                auto tile = m_Spectrograms.tile({ settings.fftSize, resolution, index }, firstBlock, tileBlocks, frequencyBins, AnalyzeResult::Levels);
+                result->tile(index, tile);
+                tiles.push_back(std::move(tile));
+            }
+
+            // Tiles used by the new result are never evicted
+            m_Spectrograms.evict();
 
             // ------------------------------------------------
 
-            AnalyzeResult result;
-            result.settings = settings;
-            result.blocks.resize(blocks);
-            result.sampleRate = buffer.sampleRate();
+            // Only blocks that aren't in the cache yet are analyzed, in chunks of BlocksPerTask, 
+            // a chunk is marked analyzed all at once. Visible tiles are analyzed first.
+            constexpr std::size_t BlocksPerTask = 16;
+
+            struct Task {
+                SpectrogramTile* tile;
+                std::size_t first;
+                std::size_t last;
+            };
+
+            std::vector<Task> tasks;
+            auto addTasks = [&](bool visible) {
+                for (auto& tile : tiles) {
+                    const std::int64_t index = tile->firstBlock() / AnalyzeResult::TileBlocks;
+                    if (visible != (index >= firstVisibleTile && index <= lastVisibleTile)) continue;
+
+                    for (std::size_t first = 0; first < tile->blocks(); first += BlocksPerTask) {
+                        if (tile->analyzed(first)) continue;
+                        tasks.push_back({ tile.get(), first, Math::min(first + BlocksPerTask, tile->blocks()) });
+                    }
+                }
+            };
+
+            addTasks(true);
+            addTasks(false);
 
             // ------------------------------------------------
 
@@ -435,11 +600,16 @@ namespace Kaixo::Processing {
             fft.progress = &m_AnalyzeProgress;
             fft.cancelation = &m_AnalyzerCanceled;
 
+            auto plan = FftPlanCache::real(settings.fftSize);
+
             // ------------------------------------------------
 
-            std::int64_t fftEstimate = blocks * fft.estimateSteps(settings.fftSize, false);
-            std::int64_t initializeEstimate = blocks * blockSize;
-            std::int64_t decibelsEstimate = blocks * frequencyBins;
+            std::int64_t analyzeBlocks = 0;
+            for (auto& task : tasks) analyzeBlocks += task.last - task.first;
+
+            std::int64_t fftEstimate = analyzeBlocks * fft.estimateRealSteps(settings.fftSize);
+            std::int64_t initializeEstimate = analyzeBlocks * blockSize;
+            std::int64_t decibelsEstimate = analyzeBlocks * frequencyBins;
 
             m_AnalyzeProgress.increaseEstimate(fftEstimate);
             m_AnalyzeProgress.increaseEstimate(initializeEstimate);
@@ -447,49 +617,61 @@ namespace Kaixo::Processing {
 
             // ------------------------------------------------
 
-            for (std::int64_t block = 0; block < blocks; ++block) {
-                result.blocks[block].result.resize(frequencyBins);
+            // Blocks are independent, so the chunks are split over the workers, every
+            // chunk with its own Fft and scratch buffers, writing to its own rows of a tile.
+            // Chunks are published as soon as they're done.
+            parallelFor(TaskPriority::Background, tasks.size(), [&](std::size_t index) {
+                const Task& task = tasks[index];
 
-                std::int64_t sampleStartOfBlock = static_cast<std::int64_t>(block * distanceBetweenBlocks);
+                Fft blockFft = fft;
+                std::vector<float> fftInput(settings.fftSize);
+                std::vector<std::complex<float>> fftOutput(frequencyBins);
 
-                // ------------------------------------------------
+                for (std::size_t local = task.first; local < task.last; ++local) {
+                    if (m_AnalyzerCanceled) return;
 
-                std::memset(fftBuffer.data(), 0, settings.fftSize * sizeof(std::complex<float>));
-                float windowScaleAdjustment = 0;
-                for (std::int64_t sampleInBlock = 0; sampleInBlock < blockSize; ++sampleInBlock) {
-                    std::int64_t sample = sampleStartOfBlock + sampleInBlock - fftLatencyAdjust;
+                    std::int16_t* row = task.tile->block(local);
 
-                    float sinWindow = 0.5f * (1.0f - Math::Fast::ncos(static_cast<float>(sampleInBlock) / (blockSize - 1)));
-                    windowScaleAdjustment += sinWindow;
+                    const std::int64_t block = task.tile->firstBlock() + static_cast<std::int64_t>(local);
+                    std::int64_t sampleStartOfBlock = static_cast<std::int64_t>(block * distanceBetweenBlocks);
 
-                    fftBuffer[sampleInBlock] = buffer.read(sample).average() * sinWindow;
+                    // ------------------------------------------------
 
-                    m_AnalyzeProgress.step(); // Initialize step
-                    if (m_AnalyzerCanceled) return result;
-                }
+                    input.readMono(sampleStartOfBlock - fftLatencyAdjust, fftInput);
+                    for (std::int64_t sampleInBlock = 0; sampleInBlock < blockSize; ++sampleInBlock) {
+                        fftInput[sampleInBlock] *= window[sampleInBlock];
+                    }
 
-                // ------------------------------------------------
+                    m_AnalyzeProgress.step(blockSize); // Initialize step
 
-                fft.transform(fftBuffer, false);
-                if (m_AnalyzerCanceled) return result;
+                    // ------------------------------------------------
 
-                // ------------------------------------------------
+                    blockFft.transformReal(*plan, fftInput, fftOutput);
+                    if (m_AnalyzerCanceled) return;
 
-                for (std::int64_t bin = 0; bin < frequencyBins; ++bin) {
-                    float magnitude = (2 * std::abs(fftBuffer[bin])) / windowScaleAdjustment;
-                    result.blocks[block].result[bin] = Math::Fast::magnitude_to_db(magnitude);
+                    // ------------------------------------------------
 
-                    if (result.blocks[block].result[bin] < -145) {
-                        result.blocks[block].result[bin] = -145;
+                    for (std::int64_t bin = 0; bin < frequencyBins; ++bin) {
+                        float magnitude = (2 * std::abs(fftOutput[bin])) / windowScaleAdjustment;
+                        row[bin] = SpectrogramTile::quantize(Math::Fast::magnitude_to_db(magnitude));
                     }
 
-                    m_AnalyzeProgress.step(); // Decibels step
-                    if (m_AnalyzerCanceled) return result;
+                    m_AnalyzeProgress.step(frequencyBins); // Decibels step
+
+                    // ------------------------------------------------
+
                 }
 
-                // ------------------------------------------------
+                // When the queue is full the blocks are still shown, once the display refreshes for another reason
+                task.tile->markAnalyzed(task.first, task.last);
+                const std::size_t firstBlock = static_cast<std::size_t>(task.tile->firstBlock()) + task.first;
+                const std::size_t lastBlock = static_cast<std::size_t>(task.tile->firstBlock()) + task.last;
+                m_AnalyzedBlocks.push({ result, firstBlock, lastBlock });
+            });
 
-            }
+            // ------------------------------------------------
+
+            if (resumePrecompute && selection == select) precompute();
 
             // ------------------------------------------------
 
@@ -503,6 +685,10 @@ namespace Kaixo::Processing {
 
     }
 
+    bool FileHandler::analyzedBlocks(AnalyzedBlocks& blocks) {
+        return m_AnalyzedBlocks.pop(blocks);
+    }
+
     void FileHandler::requestCancelAnalyze() {
         m_AnalyzerCanceled = true;
     }
@@ -517,6 +703,13 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
+    std::shared_ptr<const PeakPyramid> FileHandler::peaks() const {
+        std::lock_guard lock{ m_PeaksMutex };
+        return m_Peaks;
+    }
+
+    // ------------------------------------------------
+
     float FileHandler::analyzeProgress() const { return m_AnalyzeProgress.progress(); }
     float FileHandler::transformProgress() const { return m_TransformProgress.progress(); }
     float FileHandler::loadProgress() const { return m_LoadProgress.progress(); }
@@ -524,11 +717,7 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
-    void FileHandler::performTransform(Transform start, TransformOperation ops, Selection select, const juce::AudioBuffer<float>& from) {
-
-        // ------------------------------------------------
-
-        juce::AudioBuffer<float> result{ from.getNumChannels(), static_cast<int>(select.size) };
+    SafeAudioBuffer::View FileHandler::performTransform(Transform start, TransformOperation ops, Selection select, const juce::AudioBuffer<float>& from) {
 
         // ------------------------------------------------
 
@@ -538,70 +727,45 @@ namespace Kaixo::Processing {
         // ------------------------------------------------
 
         if (!doFlip && !doReverse) {
-            KAIXO_DEBUG("PerformTransform was called without operations, copying buffer directly.");
-
-            buffer.access([&](juce::AudioBuffer<float>& bfr, float&, std::int64_t&) { bfr = from; });
-            notifyStateChanged();
-            return;
+            KAIXO_DEBUG("PerformTransform was called without operations, using buffer directly.");
+            return SafeAudioBuffer::View::whole(from);
         }
 
         // ------------------------------------------------
 
         KAIXO_DEBUG("Performing transform '{}' with starting transform '{}'", ops, start);
-        m_TransformProgress.increaseEstimate(result.getNumChannels() * result.getNumSamples());
 
-        // ------------------------------------------------
-
-		for (int channel = 0; channel < result.getNumChannels(); ++channel) {
-            for (int i = 0; i < result.getNumSamples(); ++i) {
-                const int relativeIndex = static_cast<int>(select.start) + i;
-                const int index = static_cast<int>(doReverse ? select.end() - 1 - i : relativeIndex);
-
-                float sample = 0.f;
-                if (index >= 0 && index < from.getNumSamples()) {
-                    sample = from.getSample(channel, index);
-                }
-
-                if (doFlip) { // Spectral flip can be achieved by ring modulating with Nyquist
-                    result.setSample(channel, i, i % 2 == 0 ? sample : -sample);
-                } else {
-                    result.setSample(channel, i, sample);
-                }
-
-                m_TransformProgress.step();
-                if (m_TransformCanceled) return;
-            }
-        }
-        
-        // ------------------------------------------------
-
-        buffer.access([&](juce::AudioBuffer<float>& bfr, float&, std::int64_t&) { bfr = result; });
+        // Reversing only maps indices, and a spectral flip is ring modulating with 
+        // Nyquist, which only negates every other sample. Both are applied while reading.
+        return {
+            .offset = select.start,
+            .size = select.size,
+            .reverse = doReverse,
+            .flip = doFlip,
+        };
 
         // ------------------------------------------------
 
     }
 
-    void FileHandler::performFft(Selection select, const juce::AudioBuffer<float>& from) {
+    std::shared_ptr<const juce::AudioBuffer<float>> FileHandler::performFft(Selection select, const juce::AudioBuffer<float>& from, TaskPriority priority, ProgressCounter& progress, std::atomic_bool& cancelled) {
 
         // ------------------------------------------------
 
-        KAIXO_DEBUG("Performing FFT on buffer, and saving as Mirror270");
+        KAIXO_DEBUG("Performing FFT on buffer, giving Mirror90");
 
         // ------------------------------------------------
         
         const std::int64_t fftSize = select.size * 2 - 1;
         juce::AudioBuffer<float> result{ from.getNumChannels(), static_cast<int>(select.size) };
 
-        std::vector<std::vector<std::complex<float>>> complexBuffer{
-            static_cast<std::size_t>(from.getNumChannels()), 
-            std::vector<std::complex<float>>(static_cast<std::size_t>(fftSize))
-        };
-
         // ------------------------------------------------
 
         Fft fft{};
-        fft.progress = &m_TransformProgress;
-        fft.cancelation = &m_TransformCanceled;
+        fft.progress = &progress;
+        fft.cancelation = &cancelled;
+        fft.parallel = true;
+        fft.priority = priority;
 
         // ------------------------------------------------
 
@@ -609,96 +773,124 @@ namespace Kaixo::Processing {
         std::int64_t initializeBufferEstimate = from.getNumChannels() * from.getNumSamples();
         std::int64_t finalizeBufferEstimate = 2 * from.getNumChannels() * from.getNumSamples();
 
-        m_TransformProgress.increaseEstimate(fftStepEstimate);
-        m_TransformProgress.increaseEstimate(initializeBufferEstimate);
-        m_TransformProgress.increaseEstimate(finalizeBufferEstimate);
+        progress.increaseEstimate(fftStepEstimate);
+        progress.increaseEstimate(initializeBufferEstimate);
+        progress.increaseEstimate(finalizeBufferEstimate);
+
+        // ------------------------------------------------
+
+        fft.prepare(fftSize, true);
+        if (cancelled) return nullptr;
 
         // ------------------------------------------------
 
-        std::vector<float> sumInputs(from.getNumChannels());
-        for (int channel = 0; channel < from.getNumChannels(); ++channel) {
+        // Write pointers are fetched up front, as getting them modifies the buffer.
+        std::vector<float*> outputs(from.getNumChannels());
+        for (int channel = 0; channel < result.getNumChannels(); ++channel) {
+            outputs[channel] = result.getWritePointer(channel);
+        }
+
+        // ------------------------------------------------
+
+        // Channels are transformed concurrently, and the FFT of each channel
+        // is spread over the same scheduler.
+        parallelFor(priority, from.getNumChannels(), [&](std::size_t channel) {
+            const float* input = from.getReadPointer(static_cast<int>(channel));
+            float* output = outputs[channel];
+
+            std::vector<std::complex<float>> complexBuffer(static_cast<std::size_t>(fftSize));
+
+            // ------------------------------------------------
+
+            float sumInput = 0;
             for (int i = 0; i < select.size; ++i) {
                 const int index = static_cast<int>(select.start) + i;
 
                 float sample = 0.f;
                 if (index >= 0 && index < from.getNumSamples()) {
-                    sample = from.getSample(channel, index);
+                    sample = input[index];
                 }
 
-                complexBuffer[channel][i] = sample;
-                sumInputs[channel] += sample * sample;
+                complexBuffer[i] = sample;
+                sumInput += sample * sample;
 
-                m_TransformProgress.step();
-                if (m_TransformCanceled) return;
+                progress.step();
+                if (cancelled) return;
             }
-        }
 
-        // ------------------------------------------------
+            // ------------------------------------------------
 
-        for (auto& channel : complexBuffer) {
-            fft.transform(channel, true);
-        }
+            Fft channelFft = fft;
+            channelFft.transform(complexBuffer, true);
+            if (cancelled) return;
 
-        // ------------------------------------------------
+            // ------------------------------------------------
 
-        for (int channel = 0; channel < result.getNumChannels(); ++channel) {
             float sumOutput = 0;
             for (int i = 0; i < result.getNumSamples(); ++i) {
-                float sample = complexBuffer[channel][i].real();
-                result.setSample(channel, i, sample);
+                float sample = complexBuffer[i].real();
+                output[i] = sample;
                 sumOutput += sample * sample;
 
-                m_TransformProgress.step();
-                if (m_TransformCanceled) return;
+                progress.step();
+                if (cancelled) return;
             }
 
-            float energyRatio = Math::Fast::sqrt(sumInputs[channel] / sumOutput);
+            float energyRatio = Math::Fast::sqrt(sumInput / sumOutput);
             for (int i = 0; i < result.getNumSamples(); ++i) {
-                result.setSample(channel, i, result.getSample(channel, i) * energyRatio);
+                output[i] *= energyRatio;
 
-                m_TransformProgress.step();
-                if (m_TransformCanceled) return;
+                progress.step();
+                if (cancelled) return;
             }
-        }
+        });
+
+        if (cancelled) return nullptr;
 
         // ------------------------------------------------
 
-        m_Cache.store(Transform::Mirror90, result);
+        return std::make_shared<const juce::AudioBuffer<float>>(std::move(result));
 
         // ------------------------------------------------
 
     }
 
-    void FileHandler::performNormalize(ProgressCounter& progress, std::atomic_bool& cancelled) {
-        buffer.access([&](juce::AudioBuffer<float>& bfr, float&, std::int64_t&) {
-            std::int64_t normalizeEstimate = 2 * bfr.getNumChannels() * bfr.getNumSamples();
-            progress.increaseEstimate(normalizeEstimate);
+    void FileHandler::performNormalize(SafeAudioBuffer::View& view, const juce::AudioBuffer<float>& source, ProgressCounter& progress, std::atomic_bool& cancelled) {
+        // Reversing and flipping don't change the peak, so it's found in the source directly
+        const std::int64_t first = std::clamp<std::int64_t>(view.offset, 0, source.getNumSamples());
+        const std::int64_t last = std::clamp<std::int64_t>(view.offset + view.size, first, source.getNumSamples());
 
-            if (bfr.getNumSamples() == 0) return;
+        progress.increaseEstimate(source.getNumChannels() * (last - first));
 
-            float max = 0;
-            for (int channel = 0; channel < bfr.getNumChannels(); ++channel) {
-                for (int sample = 0; sample < bfr.getNumSamples(); ++sample) {
-                    max = Math::max(max, Math::Fast::abs(bfr.getSample(channel, sample)));
+        float max = 0;
+        for (int channel = 0; channel < source.getNumChannels(); ++channel) {
+            const float* input = source.getReadPointer(channel);
+            for (std::int64_t sample = first; sample < last; ++sample) {
+                max = Math::max(max, Math::Fast::abs(input[sample]));
 
-                    progress.step();
-                    if (cancelled) return;
-                }
+                progress.step();
+                if (cancelled) return;
             }
-            
-            for (int channel = 0; channel < bfr.getNumChannels(); ++channel) {
-                for (int sample = 0; sample < bfr.getNumSamples(); ++sample) {
-                    bfr.setSample(channel, sample, bfr.getSample(channel, sample) / max);
+        }
 
-                    progress.step();
-                    if (cancelled) return;
-                }
-            }
-        });
+        if (max > 0) view.gain = 1.f / max;
     }
 
     // ------------------------------------------------
 
+    void FileHandler::updatePeaks() {
+        std::shared_ptr<const PeakPyramid> peaks;
+        buffer.access([&](SafeAudioBuffer::ReadBuffer bfr) {
+            peaks = std::make_shared<PeakPyramid>(bfr);
+        });
+
+        if (!peaks) return;
+
+        // Only swapped while holding the lock, the old pyramid lives on as long as it's being drawn
+        std::lock_guard lock{ m_PeaksMutex };
+        m_Peaks = std::move(peaks);
+    }
+
     void FileHandler::notifyStateChanged() {
         ++m_StateCounter;
     }
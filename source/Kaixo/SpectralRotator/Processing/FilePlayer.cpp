@@ -14,23 +14,57 @@ namespace Kaixo::Processing {
     // ------------------------------------------------
 
     void FilePlayer::process() {
+        processBlock({ &output, 1 });
+    }
+
+    void FilePlayer::processBlock(std::span<Stereo> block) {
         if (!m_Playing) {
-            output = { 0, 0 };
+            std::fill(block.begin(), block.end(), Stereo{ 0, 0 });
             return;
         }
 
-		m_Resampler.sampleRate.in = m_File.sampleRate();
-		m_Resampler.sampleRate.out = sampleRate();
-
-        output = m_Resampler.generate([&] { 
-            m_PlaybackPosition.fetch_add(1, std::memory_order_relaxed);
-            return m_File.read(m_PlaybackPosition);
-        });
+        auto file = m_File.snapshot();
+        const SafeAudioBuffer::ReadBuffer reader = file.read();
+        const std::int64_t end = static_cast<std::int64_t>(reader.size());
+
+        m_Resampler.sampleRate.in = file->sampleRate;
+        m_Resampler.sampleRate.out = sampleRate();
+        m_Resampler.quality = m_Quality;
+
+        // The position is only written back if it wasn't moved by a seek during the block
+        std::int64_t startPosition = m_PlaybackPosition.load(std::memory_order_relaxed);
+        std::int64_t position = startPosition;
+
+        std::size_t rendered = 0;
+        if (m_Resampler.sampleRate.in == m_Resampler.sampleRate.out) {
+            // Same sample rate, so the block is one contiguous run of the file
+            rendered = static_cast<std::size_t>(std::clamp<std::int64_t>(end - position, 1, static_cast<std::int64_t>(block.size())));
+            reader.read(position + 1, block.first(rendered));
+            position += static_cast<std::int64_t>(rendered);
+        } else {
+            // Past the end of the file the input is silent, so the filter rings out within the block
+            rendered = block.size();
+            m_Resampler.process(block, [&](std::span<Stereo> input) {
+                reader.read(position + 1, input);
+                position += static_cast<std::int64_t>(input.size());
+            });
+
+            // Banks are built off the audio thread, until then it falls back to interpolation
+            if (!m_Resampler.ready() && !m_BankMissing.load(std::memory_order_relaxed)) {
+                m_MissingIn.store(m_Resampler.sampleRate.in, std::memory_order_relaxed);
+                m_MissingOut.store(m_Resampler.sampleRate.out, std::memory_order_relaxed);
+                m_BankMissing.store(true, std::memory_order_release);
+            }
+        }
 
-		if (m_PlaybackPosition >= static_cast<std::int64_t>(m_File.size())) {
+        // Stops at the end of the file, the rest of the block is silent
+        std::fill(block.begin() + rendered, block.end(), Stereo{ 0, 0 });
+        if (position >= end) {
             m_Playing = false;
-            m_PlaybackPosition = 0;
+            position = 0;
         }
+
+        m_PlaybackPosition.compare_exchange_strong(startPosition, position, std::memory_order_relaxed);
     }
 
     // ------------------------------------------------
@@ -42,6 +76,15 @@ namespace Kaixo::Processing {
     std::int64_t FilePlayer::playhead() const { return m_PlaybackPosition; }
     bool FilePlayer::playing() const { return m_Playing; }
 
+    void FilePlayer::quality(ResamplerQuality quality) { m_Quality = quality; }
+    ResamplerQuality FilePlayer::quality() const { return m_Quality; }
+
+    void FilePlayer::prepareResampler() {
+        if (!m_BankMissing.load(std::memory_order_acquire)) return;
+        ResamplerBank::request(m_MissingIn.load(std::memory_order_relaxed), m_MissingOut.load(std::memory_order_relaxed), m_Quality);
+        m_BankMissing.store(false, std::memory_order_release);
+    }
+
     // ------------------------------------------------
 
 }
@@ -38,6 +38,12 @@ namespace Kaixo::Processing {
         processor.file.player.seek(i);
     }
 
+    void AudioBufferInterface::quality(ResamplerQuality quality) {
+        auto& processor = self<SpectralRotatorProcessor>();
+        processor.file.player.quality(quality);
+        processor.file.player.prepareResampler();
+    }
+
     // ------------------------------------------------
 
     const SafeAudioBuffer& AudioBufferInterface::buffer() {
@@ -45,6 +51,11 @@ namespace Kaixo::Processing {
         return processor.file.buffer;
     }
 
+    std::shared_ptr<const PeakPyramid> AudioBufferInterface::peaks() {
+        auto& processor = self<SpectralRotatorProcessor>();
+        return processor.file.peaks();
+    }
+
     std::size_t AudioBufferInterface::timelineLength() {
         auto& processor = self<SpectralRotatorProcessor>();
         return processor.file.timelineLength();
@@ -71,6 +82,11 @@ namespace Kaixo::Processing {
         return processor.file.transform(instr);
     }
 
+    void AudioBufferInterface::precompute() {
+        auto& processor = self<SpectralRotatorProcessor>();
+        processor.file.precompute();
+    }
+
     float AudioBufferInterface::transformProgress() {
         auto& processor = self<SpectralRotatorProcessor>();
         return processor.file.transformProgress();
@@ -86,9 +102,14 @@ namespace Kaixo::Processing {
         return processor.file.loadProgress();
     }
 
-    std::future<AnalyzeResult> AudioBufferInterface::analyze(AnalyzeSettings settings) {
+    std::future<std::shared_ptr<const AnalyzeResult>> AudioBufferInterface::analyze(AnalyzeSettings settings, AnalyzeRange range) {
+        auto& processor = self<SpectralRotatorProcessor>();
+        return processor.file.analyze(settings, range);
+    }
+
+    bool AudioBufferInterface::analyzedBlocks(AnalyzedBlocks& blocks) {
         auto& processor = self<SpectralRotatorProcessor>();
-        return processor.file.analyze(settings);
+        return processor.file.analyzedBlocks(blocks);
     }
 
     float AudioBufferInterface::analyzeProgress() {
@@ -0,0 +1,106 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/PeakPyramid.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/ParallelFor.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    PeakPyramid::PeakPyramid(const SafeAudioBuffer::ReadBuffer& buffer)
+        : m_Size(static_cast<std::int64_t>(buffer.size()) - buffer.startOffset()), m_StartOffset(buffer.startOffset())
+    {
+        if (m_Size <= 0) return;
+
+        // ------------------------------------------------
+
+        // First level directly from the samples, in chunks that are each read at once
+        const std::int64_t blocks = (m_Size + BaseSize - 1) / BaseSize;
+        auto& base = m_Levels.emplace_back(static_cast<std::size_t>(blocks));
+
+        constexpr std::int64_t BlocksPerTask = 4096;
+        const std::size_t tasks = static_cast<std::size_t>((blocks + BlocksPerTask - 1) / BlocksPerTask);
+        parallelFor(TaskPriority::Background, tasks, [&](std::size_t task) {
+            const std::int64_t firstBlock = static_cast<std::int64_t>(task) * BlocksPerTask;
+            const std::int64_t lastBlock = Math::min(firstBlock + BlocksPerTask, blocks);
+            const std::int64_t firstSample = firstBlock * BaseSize;
+            const std::int64_t lastSample = Math::min(lastBlock * BaseSize, m_Size);
+
+            std::vector<float> samples(static_cast<std::size_t>(lastSample - firstSample));
+            buffer.readMono(m_StartOffset + firstSample, samples);
+
+            for (std::int64_t block = firstBlock; block < lastBlock; ++block) {
+                const std::int64_t first = block * BaseSize - firstSample;
+                const std::int64_t last = Math::min(first + BaseSize, lastSample - firstSample);
+
+                Peak peak{ 1, -1 };
+                for (std::int64_t i = first; i < last; ++i) {
+                    peak.min = Math::Fast::min(peak.min, samples[i]);
+                    peak.max = Math::Fast::max(peak.max, samples[i]);
+                }
+
+                base[block] = peak;
+            }
+        });
+
+        // ------------------------------------------------
+
+        // Every next level combines 2 blocks of the level below
+        while (m_Levels.back().size() > 1) {
+            const auto& below = m_Levels.back();
+            std::vector<Peak> level((below.size() + 1) / 2);
+            for (std::size_t i = 0; i < level.size(); ++i) {
+                const std::size_t second = Math::min(2 * i + 1, below.size() - 1);
+                level[i] = below[2 * i].combine(below[second]);
+            }
+
+            m_Levels.push_back(std::move(level));
+        }
+    }
+
+    // ------------------------------------------------
+
+    PeakPyramid::Peak PeakPyramid::peak(std::int64_t start, std::int64_t end) const {
+        if (m_Levels.empty()) return {};
+
+        // Samples outside the buffer are silent
+        Peak result{ 1, -1 };
+        start -= m_StartOffset;
+        end -= m_StartOffset;
+        if (start < 0 || end > m_Size) result = { 0, 0 };
+
+        const std::int64_t blocks = static_cast<std::int64_t>(m_Levels[0].size());
+        std::int64_t first = std::clamp<std::int64_t>(start >= 0 ? start / BaseSize : 0, 0, blocks);
+        std::int64_t last = std::clamp<std::int64_t>((end + BaseSize - 1) / BaseSize, first, blocks);
+        if (first == last) return { Math::min(result.min, 0.f), Math::max(result.max, 0.f) };
+
+        // Take the largest aligned blocks that fit, moving up a level from both sides
+        for (std::size_t level = 0; first < last; ++level) {
+            const auto& peaks = m_Levels[level];
+            if (first % 2 == 1) result = result.combine(peaks[first++]);
+            if (last % 2 == 1 && first < last) result = result.combine(peaks[--last]);
+            if (level + 1 == m_Levels.size()) { // Top level, combine what's left
+                for (; first < last; ++first) result = result.combine(peaks[first]);
+                break;
+            }
+
+            first /= 2;
+            last /= 2;
+        }
+
+        return result;
+    }
+
+    std::int64_t PeakPyramid::size() const { return m_Size; }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
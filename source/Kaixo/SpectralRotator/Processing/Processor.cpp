@@ -17,19 +17,36 @@ namespace Kaixo::Processing {
         registerInterface<AudioBufferInterface>();
 
         registerModule(file);
+
+        startTimerHz(20);
+    }
+
+    SpectralRotatorProcessor::~SpectralRotatorProcessor() {
+        stopTimer();
     }
 
     // ------------------------------------------------
 
     void SpectralRotatorProcessor::process() {
-        for (std::size_t i = 0; i < outputBuffer().size(); ++i) {
-            file.process();
-            outputBuffer()[i] = file.output;
+        const std::size_t samples = outputBuffer().size();
+        for (std::size_t start = 0; start < samples; start += BlockSize) {
+            std::span<Stereo> block{ m_Block.data(), Math::min(BlockSize, samples - start) };
+            file.processBlock(block);
+
+            for (std::size_t i = 0; i < block.size(); ++i) {
+                outputBuffer()[start + i] = block[i];
+            }
         }
     }
 
     // ------------------------------------------------
 
+    void SpectralRotatorProcessor::timerCallback() {
+        file.player.prepareResampler();
+    }
+
+    // ------------------------------------------------
+
     Processor* createProcessor() { return new SpectralRotatorProcessor(); }
 
     // ------------------------------------------------
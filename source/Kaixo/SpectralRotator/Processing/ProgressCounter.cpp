@@ -21,6 +21,7 @@ namespace Kaixo::Processing {
     void ProgressCounter::reset() { m_Steps = 0; m_Estimate = 1; }
     void ProgressCounter::increaseEstimate(std::int64_t v) { m_Estimate += v; }
     void ProgressCounter::step() { m_Steps++; }
+    void ProgressCounter::step(std::int64_t amount) { m_Steps += amount; }
     void ProgressCounter::done() { m_Steps = m_Estimate.load(); }
 
     // ------------------------------------------------
@@ -0,0 +1,175 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/ResamplerBank.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/SincTable.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/TaskScheduler.hpp"
+
+// ------------------------------------------------
+
+#include <numeric>
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    namespace {
+        struct BankKey {
+            std::int64_t in;  // Rates in hundredths of a Hz
+            std::int64_t out;
+            ResamplerQuality quality;
+
+            auto operator<=>(const BankKey&) const = default;
+        };
+
+        BankKey bankKey(float in, float out, ResamplerQuality quality) {
+            return { std::llround(in * 100.0), std::llround(out * 100.0), quality };
+        }
+
+        struct BankCache {
+            std::mutex mutex{};
+            std::map<BankKey, std::shared_ptr<const ResamplerBank>> banks{}; // nullptr while being built
+        };
+
+        BankCache& bankCache() {
+            static BankCache cache{};
+            return cache;
+        }
+    }
+
+    // ------------------------------------------------
+
+    std::shared_ptr<const ResamplerBank> ResamplerBank::find(float in, float out, ResamplerQuality quality) {
+        if (in <= 0 || out <= 0) return nullptr;
+
+        auto& cache = bankCache();
+        std::unique_lock lock{ cache.mutex, std::try_to_lock };
+        if (!lock) return nullptr; // Being updated, try again next time
+
+        auto it = cache.banks.find(bankKey(in, out, quality));
+        if (it == cache.banks.end()) return nullptr;
+        return it->second;
+    }
+
+    void ResamplerBank::request(float in, float out, ResamplerQuality quality) {
+        if (in <= 0 || out <= 0) return;
+
+        {
+            auto& cache = bankCache();
+            std::lock_guard lock{ cache.mutex };
+            auto [it, inserted] = cache.banks.try_emplace(bankKey(in, out, quality));
+            if (!inserted) return; // Built, or being built
+        }
+
+        TaskScheduler::shared()->post(TaskPriority::Audio, [in, out, quality] { prepare(in, out, quality); });
+    }
+
+    void ResamplerBank::prepare(float in, float out, ResamplerQuality quality) {
+        if (in <= 0 || out <= 0) return;
+
+        auto& cache = bankCache();
+        const BankKey key = bankKey(in, out, quality);
+
+        {
+            std::lock_guard lock{ cache.mutex };
+            auto it = cache.banks.find(key);
+            if (it != cache.banks.end() && it->second) return;
+        }
+
+        // Built without holding the lock, so the audio thread can keep looking up other banks
+        auto bank = std::make_shared<const ResamplerBank>(in, out, quality);
+
+        std::lock_guard lock{ cache.mutex };
+        auto& entry = cache.banks[key];
+        if (!entry) entry = std::move(bank);
+    }
+
+    // ------------------------------------------------
+
+    ResamplerBank::ResamplerBank(float in, float out, ResamplerQuality quality) {
+
+        // ------------------------------------------------
+
+        // A phase for every distinct output position when the rates are whole numbers with a small ratio
+        bool exact = false;
+        auto whole = [](float rate) { return std::abs(rate - std::round(rate)) < 1e-3f; };
+        if (whole(in) && whole(out)) {
+            const std::int64_t input = std::llround(in);
+            const std::int64_t output = std::llround(out);
+            const std::int64_t divisor = std::gcd(input, output);
+            if (output / divisor <= static_cast<std::int64_t>(MaxPhases)) {
+                m_Phases = static_cast<std::size_t>(output / divisor);
+                m_Step = static_cast<std::size_t>(input / divisor);
+                exact = true;
+            }
+        }
+
+        if (!exact) {
+            m_Phases = MaxPhases;
+            m_Step = static_cast<std::size_t>(std::max<std::int64_t>(std::llround(static_cast<double>(in) / out * MaxPhases), 1));
+        }
+
+        // ------------------------------------------------
+
+        struct Settings {
+            std::size_t radius; // Zero crossings on each side, at the input rate when not downsampling
+            double rolloff;     // Cutoff relative to the lowest Nyquist frequency
+        };
+
+        constexpr Settings settings[]{
+            { 4, 0.80 },  // Draft
+            { 16, 0.90 }, // Normal
+            { 32, 0.95 }, // High
+        };
+
+        const Settings& setting = settings[static_cast<std::size_t>(quality)];
+
+        // Relative to the input's Nyquist frequency
+        const double scale = Math::min(static_cast<double>(out) / in, 1.0);
+        const double cutoff = setting.rolloff * scale;
+
+        m_Radius = std::min(static_cast<std::size_t>(std::ceil(setting.radius / scale)), MaxRadius);
+        m_Taps = (2 * m_Radius + 3) / 4 * 4;
+
+        // ------------------------------------------------
+
+        m_Coefficients.resize(m_Phases * m_Taps, 0.f);
+
+        const double radius = static_cast<double>(m_Radius);
+        const std::int64_t history = static_cast<std::int64_t>(m_Radius) - 1;
+        for (std::size_t phase = 0; phase < m_Phases; ++phase) {
+            const double fraction = static_cast<double>(phase) / m_Phases;
+            float* row = m_Coefficients.data() + phase * m_Taps;
+
+            auto weight = [&](std::size_t tap) {
+                const double distance = fraction - static_cast<double>(static_cast<std::int64_t>(tap) - history);
+                return cutoff * sinc(cutoff * distance) * blackman(distance * std::numbers::pi / radius);
+            };
+
+            double norm = 0;
+            for (std::size_t tap = 0; tap < 2 * m_Radius; ++tap) {
+                norm += weight(tap);
+            }
+
+            for (std::size_t tap = 0; tap < 2 * m_Radius; ++tap) {
+                row[tap] = static_cast<float>(norm != 0 ? weight(tap) / norm : 0);
+            }
+        }
+
+        // ------------------------------------------------
+
+    }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
@@ -7,109 +7,248 @@
 
 namespace Kaixo::Processing {
     
+    // ------------------------------------------------
+
+    /** Splits a range in the silent part before the view, the part inside
+        the view, and the silent part after the view.
+
+        @returns the amount of silent samples at the start, and the amount of samples inside the view.
+     */
+    std::pair<std::size_t, std::size_t> splitRange(std::int64_t samples, std::int64_t index, std::size_t size) {
+        const std::int64_t end = index + static_cast<std::int64_t>(size);
+        const std::int64_t first = std::clamp<std::int64_t>(index, 0, samples);
+        const std::int64_t last = std::clamp<std::int64_t>(end, first, samples);
+
+        // When the range ends before the view, all of it is silent
+        const std::int64_t before = std::clamp<std::int64_t>(first - index, 0, static_cast<std::int64_t>(size));
+        return { static_cast<std::size_t>(before), static_cast<std::size_t>(last - first) };
+    }
+
+    /** Calls a function with the source index and gain of the samples of a view
+        in a range, the range has to be inside the view.
+
+        @param fun                  called with the position in the range, the source index, and the gain.
+     */
+    void forEachSample(const SafeAudioBuffer::View& view, std::int64_t index, std::size_t count, auto fun) {
+        const std::int64_t direction = view.reverse ? -1 : 1;
+        const std::int64_t first = view.reverse ? view.offset + view.size - 1 - index : view.offset + index;
+        for (std::size_t i = 0; i < count; ++i) {
+            const bool negate = view.flip && ((index + static_cast<std::int64_t>(i)) % 2 != 0);
+            fun(i, first + direction * static_cast<std::int64_t>(i), negate ? -view.gain : view.gain);
+        }
+    }
+
+    void readMonoFrom(const juce::AudioBuffer<float>& bfr, const SafeAudioBuffer::View& view, std::int64_t index, std::span<float> output) {
+        auto [before, inside] = splitRange(view.size, index, output.size());
+        if (bfr.getNumChannels() < 1) inside = 0;
+
+        std::fill_n(output.begin(), before, 0.f);
+        std::fill(output.begin() + before + inside, output.end(), 0.f);
+        if (inside == 0) return;
+
+        const std::int64_t samples = bfr.getNumSamples();
+        const float* left = bfr.getReadPointer(0);
+        const float* right = bfr.getNumChannels() == 1 ? left : bfr.getReadPointer(1);
+        float* out = output.data() + before;
+
+        forEachSample(view, index + static_cast<std::int64_t>(before), inside, [&](std::size_t i, std::int64_t source, float gain) {
+            if (source < 0 || source >= samples) out[i] = 0.f;
+            else out[i] = 0.5f * gain * (left[source] + right[source]);
+        });
+    }
+
+    void readFrom(const juce::AudioBuffer<float>& bfr, const SafeAudioBuffer::View& view, std::int64_t index, std::span<Stereo> output) {
+        auto [before, inside] = splitRange(view.size, index, output.size());
+        if (bfr.getNumChannels() < 1) inside = 0;
+
+        std::fill_n(output.begin(), before, Stereo{ 0, 0 });
+        std::fill(output.begin() + before + inside, output.end(), Stereo{ 0, 0 });
+        if (inside == 0) return;
+
+        const std::int64_t samples = bfr.getNumSamples();
+        const float* left = bfr.getReadPointer(0);
+        const float* right = bfr.getNumChannels() == 1 ? left : bfr.getReadPointer(1);
+        Stereo* out = output.data() + before;
+
+        forEachSample(view, index + static_cast<std::int64_t>(before), inside, [&](std::size_t i, std::int64_t source, float gain) {
+            if (source < 0 || source >= samples) out[i] = { 0, 0 };
+            else out[i] = { gain * left[source], gain * right[source] };
+        });
+    }
+
+    // An empty buffer, read by snapshots without a source.
+    const juce::AudioBuffer<float>& emptyBuffer() {
+        static const juce::AudioBuffer<float> buffer{};
+        return buffer;
+    }
+
+    // ------------------------------------------------
+    //                     View
+    // ------------------------------------------------
+
+    SafeAudioBuffer::View SafeAudioBuffer::View::whole(const Buffer& buffer) {
+        return { .offset = 0, .size = buffer.getNumSamples() };
+    }
+
+    bool SafeAudioBuffer::View::isWhole(const Buffer& buffer) const {
+        return offset == 0 && size == buffer.getNumSamples() && !reverse && !flip && gain == 1;
+    }
+
+    // ------------------------------------------------
+    //                   Snapshot
+    // ------------------------------------------------
+
+    std::shared_ptr<const SafeAudioBuffer::Buffer> SafeAudioBuffer::Snapshot::materialize() const {
+        const Buffer& from = source ? *source : emptyBuffer();
+        if (source && view.isWhole(from)) return source;
+
+        auto result = std::make_shared<Buffer>(from.getNumChannels(), static_cast<int>(view.size));
+        const std::int64_t samples = from.getNumSamples();
+        for (int channel = 0; channel < result->getNumChannels(); ++channel) {
+            const float* input = from.getReadPointer(channel);
+            float* output = result->getWritePointer(channel);
+            forEachSample(view, 0, static_cast<std::size_t>(view.size), [&](std::size_t i, std::int64_t index, float gain) {
+                output[i] = index < 0 || index >= samples ? 0.f : gain * input[index];
+            });
+        }
+
+        return result;
+    }
+
     // ------------------------------------------------
     //                  ReadBuffer
     // ------------------------------------------------
     
     SafeAudioBuffer::ReadBuffer::ReadBuffer(const juce::AudioBuffer<float>& bfr, float sampleRate, std::int64_t startOffset)
+        : ReadBuffer(bfr, View::whole(bfr), sampleRate, startOffset)
+    {}
+
+    SafeAudioBuffer::ReadBuffer::ReadBuffer(const juce::AudioBuffer<float>& bfr, const View& view, float sampleRate, std::int64_t startOffset)
         : m_Buffer(bfr)
+        , m_View(view)
         , m_SampleRate(sampleRate)
         , m_StartOffset(startOffset)
     {}
 
+    SafeAudioBuffer::ReadBuffer::ReadBuffer(const Snapshot& snapshot)
+        : ReadBuffer(snapshot.source ? *snapshot.source : emptyBuffer(), snapshot.view, snapshot.sampleRate, snapshot.startOffset)
+    {}
+
     // ------------------------------------------------
 
     Stereo SafeAudioBuffer::ReadBuffer::operator[](std::int64_t index) const {
-        index -= m_StartOffset;
-
-        if (index < 0 || index >= m_Buffer.getNumSamples()) {
-            return { 0, 0 };
-        }
-
-        int numChannels = m_Buffer.getNumChannels();
-        if (numChannels < 1) {
-            return { 0, 0 };
-        }
+        Stereo result{ 0, 0 };
+        readFrom(m_Buffer, m_View, index - m_StartOffset, { &result, 1 });
+        return result;
+    }
 
-        if (numChannels == 1) {
-            float sample = m_Buffer.getSample(0, static_cast<int>(index));
-            return { sample, sample };
-        }
+    // ------------------------------------------------
 
-        Processing::Stereo result{
-            m_Buffer.getSample(0, static_cast<int>(index)),
-            m_Buffer.getSample(1, static_cast<int>(index)),
-        };
+    void SafeAudioBuffer::ReadBuffer::readMono(std::int64_t start, std::span<float> output) const {
+        readMonoFrom(m_Buffer, m_View, start - m_StartOffset, output);
+    }
 
-        return result;
+    void SafeAudioBuffer::ReadBuffer::read(std::int64_t start, std::span<Stereo> output) const {
+        readFrom(m_Buffer, m_View, start - m_StartOffset, output);
     }
 
     // ------------------------------------------------
     
-    std::size_t SafeAudioBuffer::ReadBuffer::size() const { return m_Buffer.getNumSamples() + m_StartOffset; }
+    std::size_t SafeAudioBuffer::ReadBuffer::size() const { return m_View.size + m_StartOffset; }
     float SafeAudioBuffer::ReadBuffer::sampleRate() const { return m_SampleRate; }
+    std::int64_t SafeAudioBuffer::ReadBuffer::startOffset() const { return m_StartOffset; }
 
     // ------------------------------------------------
-    //               SafeAudioBuffer
+    //                    Reader
     // ------------------------------------------------
 
-	void SafeAudioBuffer::access(Callback callback) {
-        auto _ = m_Lock.write();
-        std::int64_t start = startOffset.load();
-        callback(m_Buffer, m_SampleRate, start);
-        startOffset = start;
+    SafeAudioBuffer::Reader::Reader(const SafeAudioBuffer& buffer) {
+        // While m_Acquiring is set, the writer won't free any snapshot, so the
+        // loaded snapshot stays alive until it has been registered on.
+        buffer.m_Acquiring.fetch_add(1);
+        m_Node = buffer.m_Current.load();
+        m_Node->readers.fetch_add(1);
+        buffer.m_Acquiring.fetch_sub(1);
     }
 
-	void SafeAudioBuffer::access(ConstCallback callback) const {
-        auto locked = m_Lock.read();
-        if (locked) {
-            callback({ m_Buffer, m_SampleRate, startOffset.load() });
-        }
+    SafeAudioBuffer::Reader::Reader(Reader&& other) noexcept
+        : m_Node(std::exchange(other.m_Node, nullptr))
+    {}
+
+    SafeAudioBuffer::Reader::~Reader() {
+        if (m_Node) m_Node->readers.fetch_sub(1);
     }
 
+    // ------------------------------------------------
+    //               SafeAudioBuffer
     // ------------------------------------------------
 
-	std::size_t SafeAudioBuffer::size() const {
-        auto locked = m_Lock.read();
-        if (!locked) return startOffset;
-        return m_Buffer.getNumSamples() + startOffset;
+    SafeAudioBuffer::SafeAudioBuffer() 
+        : m_Current(new Node{}) 
+    {}
+
+    SafeAudioBuffer::~SafeAudioBuffer() {
+        delete m_Current.load();
+    }
+
+    // ------------------------------------------------
+
+    void SafeAudioBuffer::publish(Buffer buffer, float sampleRate, std::int64_t startOffset) {
+        const View view = View::whole(buffer);
+        publish(std::make_shared<const Buffer>(std::move(buffer)), view, sampleRate, startOffset);
     }
 
-	float SafeAudioBuffer::sampleRate() const {
-        auto locked = m_Lock.read();
-        if (!locked) return 0;
-        return m_SampleRate; 
+    void SafeAudioBuffer::publish(std::shared_ptr<const Buffer> source, View view, float sampleRate, std::int64_t startOffset) {
+        std::lock_guard lock{ m_PublishMutex };
+
+        auto node = std::make_unique<Node>();
+        node->snapshot.source = std::move(source);
+        node->snapshot.view = view;
+        node->snapshot.sampleRate = sampleRate;
+        node->snapshot.startOffset = startOffset;
+        node->snapshot.version = ++m_Version;
+
+        m_Retired.emplace_back(m_Current.exchange(node.release()));
+        reclaim();
+    }
+
+    void SafeAudioBuffer::reclaim() {
+        // A reader that starts acquiring after this check gets the current snapshot, and
+        // a reader that finished acquiring before it is counted in the snapshot's readers.
+        if (m_Acquiring.load() != 0) return;
+
+        std::erase_if(m_Retired, [](const std::unique_ptr<Node>& node) {
+            return node->readers.load() == 0;
+        });
     }
 
     // ------------------------------------------------
 
-    Processing::Stereo SafeAudioBuffer::read(std::int64_t index) const {
-        auto locked = m_Lock.read();
-        if (!locked) return { 0, 0 };
+    SafeAudioBuffer::Reader SafeAudioBuffer::snapshot() const { return *this; }
 
-        index -= startOffset;
+    void SafeAudioBuffer::access(ConstCallback callback) const {
+        Reader reader = snapshot();
+        callback(reader.read());
+    }
 
-        if (index < 0 || index >= m_Buffer.getNumSamples()) {
-            return { 0, 0 };
-        }
+    // ------------------------------------------------
 
-		int numChannels = m_Buffer.getNumChannels();
-        if (numChannels < 1) {
-            return { 0, 0 };
-		}
+    std::size_t SafeAudioBuffer::size() const { return snapshot().read().size(); }
+    float SafeAudioBuffer::sampleRate() const { return snapshot()->sampleRate; }
+    std::int64_t SafeAudioBuffer::startOffset() const { return snapshot()->startOffset; }
+    std::size_t SafeAudioBuffer::version() const { return snapshot()->version; }
 
-        if (numChannels == 1) {
-            float sample = m_Buffer.getSample(0, static_cast<int>(index));
-            return { sample, sample };
-        }
+    // ------------------------------------------------
 
-        Processing::Stereo result{ 
-            m_Buffer.getSample(0, static_cast<int>(index)), 
-            m_Buffer.getSample(1, static_cast<int>(index)), 
-        };
+    Processing::Stereo SafeAudioBuffer::read(std::int64_t index) const { return snapshot().read()[index]; }
 
-        return result;
-	}
+    void SafeAudioBuffer::readMono(std::int64_t start, std::span<float> output) const {
+        snapshot().read().readMono(start, output);
+    }
+
+    void SafeAudioBuffer::read(std::int64_t start, std::span<Stereo> output) const {
+        snapshot().read().read(start, output);
+    }
 
     // ------------------------------------------------
 
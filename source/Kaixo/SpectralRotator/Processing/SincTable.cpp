@@ -0,0 +1,84 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/SincTable.hpp"
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/Float4.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    double sinc(double x) {
+        if (std::abs(x) < 1.0e-9) return 1.0;
+        x *= std::numbers::pi;
+        return std::sin(x) / x;
+    }
+
+    double blackman(double x) {
+        return 0.42 + 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x);
+    }
+
+    // ------------------------------------------------
+
+    const SincTable& SincTable::instance() {
+        static const SincTable table{};
+        return table;
+    }
+
+    SincTable::SincTable() {
+        // One extra phase for a fraction of exactly 1, so rounding never has to wrap to the next sample
+        m_Coefficients.resize((Phases + 1) * PaddedTaps, 0.f);
+
+        for (std::size_t phase = 0; phase <= Phases; ++phase) {
+            const double fraction = static_cast<double>(phase) / Phases;
+            float* row = m_Coefficients.data() + phase * PaddedTaps;
+
+            double norm = 0;
+            for (std::int64_t i = -Radius; i <= Radius; ++i) {
+                const double distance = fraction - static_cast<double>(i);
+                norm += sinc(distance) * blackman(distance * std::numbers::pi / Radius);
+            }
+
+            for (std::int64_t i = -Radius; i <= Radius; ++i) {
+                const double distance = fraction - static_cast<double>(i);
+                const double weight = sinc(distance) * blackman(distance * std::numbers::pi / Radius);
+                row[i + Radius] = static_cast<float>(norm != 0 ? weight / norm : 0);
+            }
+        }
+    }
+
+    // ------------------------------------------------
+
+    const float* SincTable::coefficients(float fraction) const {
+        const std::size_t phase = static_cast<std::size_t>(std::clamp(fraction, 0.f, 1.f) * Phases + 0.5f);
+        return m_Coefficients.data() + phase * PaddedTaps;
+    }
+
+    float SincTable::interpolate(const float* samples, float fraction) const {
+        // Blend the 2 closest phases, so the result doesn't depend on the table's resolution
+        const float position = std::clamp(fraction, 0.f, 1.f) * Phases;
+        const std::size_t phase = Math::min(static_cast<std::size_t>(position), Phases - 1);
+        const Float4 ratio = Float4::broadcast(position - phase);
+        const float* kernel1 = m_Coefficients.data() + phase * PaddedTaps;
+        const float* kernel2 = kernel1 + PaddedTaps;
+
+        Float4 sum = Float4::broadcast(0.f);
+        for (std::size_t i = 0; i < PaddedTaps; i += Float4::Width) {
+            const Float4 k1 = Float4::load(kernel1 + i);
+            const Float4 k2 = Float4::load(kernel2 + i);
+            sum = sum + Float4::load(samples + i) * (k1 + (k2 - k1) * ratio);
+        }
+
+        return sum.sum();
+    }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
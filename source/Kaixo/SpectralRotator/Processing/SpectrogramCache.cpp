@@ -0,0 +1,59 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/SpectrogramCache.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    void SpectrogramCache::invalidate(std::size_t version) {
+        if (m_Version == version) return;
+
+        KAIXO_DEBUG("Invalidating spectrogram cache.");
+        m_Version = version;
+        m_Entries.clear();
+        m_Index.clear();
+        m_Bytes = 0;
+    }
+
+    void SpectrogramCache::budget(std::size_t bytes) {
+        m_Budget = bytes;
+        evict();
+    }
+
+    std::size_t SpectrogramCache::bytes() const { return m_Bytes; }
+
+    // ------------------------------------------------
+
+    std::shared_ptr<SpectrogramTile> SpectrogramCache::tile(Key key, std::int64_t firstBlock, std::size_t blocks, std::size_t bins, std::size_t levels) {
+        if (auto it = m_Index.find(key); it != m_Index.end()) {
+            m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+            return it->second->tile;
+        }
+
+        auto tile = std::make_shared<SpectrogramTile>(firstBlock, blocks, bins, levels);
+        m_Entries.push_front({ key, tile });
+        m_Index[key] = m_Entries.begin();
+        m_Bytes += tile->bytes();
+        return tile;
+    }
+
+    void SpectrogramCache::evict() {
+        for (auto it = m_Entries.end(); it != m_Entries.begin() && m_Bytes > m_Budget;) {
+            --it;
+            if (it->tile.use_count() > 1) continue; // Still used by an analyze result
+
+            m_Bytes -= it->tile->bytes();
+            m_Index.erase(it->key);
+            it = m_Entries.erase(it);
+        }
+    }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
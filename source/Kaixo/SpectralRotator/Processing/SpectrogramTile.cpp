@@ -0,0 +1,123 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/SpectralRotator/Processing/SpectrogramTile.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo::Processing {
+
+    // ------------------------------------------------
+
+    SpectrogramTile::SpectrogramTile(std::int64_t firstBlock, std::size_t blocks, std::size_t bins, std::size_t levels)
+        : m_FirstBlock(firstBlock), m_Bins(bins)
+    {
+        constexpr std::size_t ValuesPerAlignment = Alignment / sizeof(std::int16_t);
+        m_Stride = (bins + ValuesPerAlignment - 1) / ValuesPerAlignment * ValuesPerAlignment;
+
+        m_Levels.resize(std::max<std::size_t>(levels, 1));
+        for (std::size_t level = 0; level < m_Levels.size(); ++level) {
+            Level& data = m_Levels[level];
+            data.blocks = level == 0 ? blocks : (m_Levels[level - 1].blocks + Reduction - 1) / Reduction;
+            data.firstRow = m_Rows;
+            data.analyzed = std::make_unique<std::atomic_bool[]>(data.blocks);
+            if (level != 0) data.children = std::make_unique<std::atomic_uint8_t[]>(data.blocks);
+            m_Rows += data.blocks;
+        }
+
+        const std::size_t size = m_Stride * m_Rows;
+        if (size == 0) return;
+
+        m_Data.reset(static_cast<std::int16_t*>(::operator new[](size * sizeof(std::int16_t), std::align_val_t{ Alignment })));
+    }
+
+    void SpectrogramTile::AlignedDelete::operator()(std::int16_t* ptr) const {
+        ::operator delete[](ptr, std::align_val_t{ Alignment });
+    }
+
+    // ------------------------------------------------
+
+    std::int64_t SpectrogramTile::firstBlock() const { return m_FirstBlock; }
+    std::size_t SpectrogramTile::blocks(std::size_t level) const { return m_Levels[level].blocks; }
+    std::size_t SpectrogramTile::bins() const { return m_Bins; }
+    std::size_t SpectrogramTile::levels() const { return m_Levels.size(); }
+
+    std::size_t SpectrogramTile::bytes() const { 
+        return m_Stride * m_Rows * sizeof(std::int16_t) + m_Rows * (sizeof(std::atomic_bool) + sizeof(std::atomic_uint8_t));
+    }
+
+    // ------------------------------------------------
+
+    std::int16_t* SpectrogramTile::block(std::size_t block, std::size_t level) { 
+        return m_Data.get() + (m_Levels[level].firstRow + block) * m_Stride; 
+    }
+
+    const std::int16_t* SpectrogramTile::block(std::size_t block, std::size_t level) const { 
+        return m_Data.get() + (m_Levels[level].firstRow + block) * m_Stride; 
+    }
+
+    // ------------------------------------------------
+
+    bool SpectrogramTile::analyzed(std::size_t block, std::size_t level) const {
+        if (level >= m_Levels.size()) return false;
+        const Level& data = m_Levels[level];
+        return block < data.blocks && data.analyzed[block].load(std::memory_order_acquire);
+    }
+
+    bool SpectrogramTile::complete() const {
+        return m_AnalyzedCount.load(std::memory_order_acquire) == blocks();
+    }
+
+    void SpectrogramTile::markAnalyzed(std::size_t first, std::size_t last) {
+        for (std::size_t block = first; block < last; ++block) {
+            markBlock(block, 0);
+        }
+    }
+
+    void SpectrogramTile::markBlock(std::size_t block, std::size_t level) {
+        if (m_Levels[level].analyzed[block].exchange(true, std::memory_order_acq_rel)) return;
+        if (level == 0) m_AnalyzedCount.fetch_add(1, std::memory_order_acq_rel);
+
+        const std::size_t parentLevel = level + 1;
+        if (parentLevel >= m_Levels.size()) return;
+
+        // The thread that analyzes the last child of the parent reduces it, so it's reduced exactly once
+        const std::size_t parent = block / Reduction;
+        const std::size_t children = Math::min((parent + 1) * Reduction, m_Levels[level].blocks) - parent * Reduction;
+        if (m_Levels[parentLevel].children[parent].fetch_add(1, std::memory_order_acq_rel) + 1u == children) {
+            reduce(parent, parentLevel);
+            markBlock(parent, parentLevel);
+        }
+    }
+
+    void SpectrogramTile::reduce(std::size_t block, std::size_t level) {
+        const std::size_t first = block * Reduction;
+        const std::size_t last = Math::min(first + Reduction, m_Levels[level - 1].blocks);
+        const std::int32_t count = static_cast<std::int32_t>(last - first);
+
+        std::int16_t* row = this->block(block, level);
+        for (std::size_t bin = 0; bin < m_Bins; ++bin) {
+            std::int32_t sum = 0;
+            for (std::size_t child = first; child < last; ++child) {
+                sum += this->block(child, level - 1)[bin];
+            }
+
+            row[bin] = static_cast<std::int16_t>(sum / count);
+        }
+    }
+
+    // ------------------------------------------------
+
+    std::int16_t SpectrogramTile::quantize(float decibels) {
+        return static_cast<std::int16_t>(std::lround(std::clamp(decibels, MinDecibels, MaxDecibels) * StepsPerDecibel));
+    }
+
+    float SpectrogramTile::dequantize(std::int16_t value) {
+        return value / StepsPerDecibel;
+    }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
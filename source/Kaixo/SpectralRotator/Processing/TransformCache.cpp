@@ -32,15 +32,103 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
+    namespace {
+        std::size_t bytesOf(const juce::AudioBuffer<float>& buffer) {
+            return static_cast<std::size_t>(buffer.getNumChannels()) * static_cast<std::size_t>(buffer.getNumSamples()) * sizeof(float);
+        }
+
+        // Entries are spilled cheapest to recompute first. Identity can't be recomputed 
+        // at all, and every other transform starts from it, so it goes last.
+        int spillOrder(Transform t) {
+            if (t == Transform::Identity) return 2;
+            return static_cast<std::uint8_t>(t) & 0b001 ? 1 : 0; // Quarter rotations need an FFT
+        }
+    }
+
+    // ------------------------------------------------
+
+    std::unique_ptr<TransformCache::Spill> TransformCache::Spill::write(const Buffer& buffer) {
+        juce::File file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getNonexistentChildFile("SpectralRotator-cache", ".raw", false);
+
+        // Owns the file from here on, so it's deleted when writing fails
+        auto spill = std::make_unique<Spill>(file, buffer.getNumChannels(), buffer.getNumSamples());
+
+        {
+            juce::FileOutputStream stream{ file };
+            if (!stream.openedOk()) return nullptr;
+
+            // Channels one after another
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+                const std::size_t size = static_cast<std::size_t>(buffer.getNumSamples()) * sizeof(float);
+                if (!stream.write(buffer.getReadPointer(channel), size)) return nullptr;
+            }
+
+            stream.flush();
+            if (stream.getStatus().failed()) return nullptr;
+        }
+
+        return spill;
+    }
+
+    // ------------------------------------------------
+
+    TransformCache::Spill::Spill(juce::File file, int channels, int samples)
+        : m_File(std::move(file))
+        , m_Channels(channels)
+        , m_Samples(samples)
+    {}
+
+    TransformCache::Spill::~Spill() {
+        m_File.deleteFile();
+    }
+
+    // ------------------------------------------------
+
+    std::shared_ptr<const juce::AudioBuffer<float>> TransformCache::Spill::map(std::unique_ptr<Spill> spill) {
+        struct Mapped {
+            std::unique_ptr<Spill> spill; // Destroyed last, the file can only be deleted once it's unmapped
+            juce::MemoryMappedFile file;
+            std::vector<float*> channels{};
+            Buffer buffer{};
+
+            Mapped(std::unique_ptr<Spill> s)
+                : spill(std::move(s)), file(spill->m_File, juce::MemoryMappedFile::readOnly)
+            {}
+        };
+
+        const int channels = spill->m_Channels;
+        const int samples = spill->m_Samples;
+        const std::size_t bytes = static_cast<std::size_t>(channels) * static_cast<std::size_t>(samples) * sizeof(float);
+
+        auto mapped = std::make_shared<Mapped>(std::move(spill));
+        if (mapped->file.getData() == nullptr || mapped->file.getSize() < bytes) return nullptr;
+
+        // The mapping is read-only, the buffer is only ever used as const
+        float* data = static_cast<float*>(mapped->file.getData());
+        for (int channel = 0; channel < channels; ++channel) {
+            mapped->channels.push_back(data + static_cast<std::size_t>(channel) * samples);
+        }
+
+        mapped->buffer.setDataToReferTo(mapped->channels.data(), channels, samples);
+        return std::shared_ptr<const Buffer>{ mapped, &mapped->buffer };
+    }
+
+    // ------------------------------------------------
+
     void TransformCache::invalidate() {
         KAIXO_DEBUG("Invalidating cache.");
+        std::lock_guard lock{ m_Mutex };
 		m_Cache.clear();
+        m_Bytes = 0;
     }
 
     void TransformCache::clearExceptIdentity() {
         KAIXO_DEBUG("Clearing cache, except Identity.");
+        std::lock_guard lock{ m_Mutex };
         for (auto it = m_Cache.begin(); it != m_Cache.end(); ) {
             if (it->first != Transform::Identity) {
+                if (!it->second.spilled) m_Bytes -= bytesOf(*it->second.buffer);
                 it = m_Cache.erase(it);  // erase returns next iterator
             } else {
                 ++it;
@@ -50,22 +138,135 @@ namespace Kaixo::Processing {
 
     // ------------------------------------------------
 
-    void TransformCache::store(Transform t, const juce::AudioBuffer<float>& buffer) {
+    void TransformCache::budget(std::size_t bytes) {
+        std::lock_guard lock{ m_Mutex };
+        m_Budget = bytes;
+        spillOverBudget();
+    }
+
+    std::size_t TransformCache::budget() const { 
+        std::lock_guard lock{ m_Mutex };
+        return m_Budget; 
+    }
+
+    std::size_t TransformCache::bytes() const { 
+        std::lock_guard lock{ m_Mutex };
+        return m_Bytes; 
+    }
+
+    // ------------------------------------------------
+
+    void TransformCache::store(Transform t, std::shared_ptr<const Buffer> buffer) {
+        std::lock_guard lock{ m_Mutex };
         if (m_Cache.contains(t)) {
             KAIXO_DEBUG("Tried to store transfor {} in cache, but already exists.", t);
             return; // Don't store if already in cache.
         }
 
         KAIXO_DEBUG("Storing transform {} in cache", t);
-        m_Cache[t] = buffer;
+        m_Bytes += bytesOf(*buffer);
+        m_Cache[t].buffer = std::move(buffer);
+        spillOverBudget();
 	}
 
-    const juce::AudioBuffer<float>& TransformCache::get(Transform t) const {
+    std::shared_ptr<const juce::AudioBuffer<float>> TransformCache::get(Transform t) {
         KAIXO_DEBUG("Getting transform '{}' from cache.", t);
-        return m_Cache.at(t);
+        std::shared_ptr<const Buffer> buffer{};
+
+        {
+            std::lock_guard lock{ m_Mutex };
+            const Entry& entry = m_Cache.at(t);
+            if (!entry.spilled) return entry.buffer;
+            buffer = entry.buffer;
+        }
+
+        return readBack(t, std::move(buffer));
 	}
 
-    bool TransformCache::contains(Transform t) const { return m_Cache.contains(t); }
+    bool TransformCache::contains(Transform t) const { 
+        std::lock_guard lock{ m_Mutex };
+        return m_Cache.contains(t); 
+    }
+
+    // ------------------------------------------------
+
+    void TransformCache::spillOverBudget() {
+        if (m_Spilling || m_Bytes <= m_Budget) return;
+
+        // Writing hundreds of megabytes takes a while, so it's never done by the caller
+        m_Spilling = true;
+        m_Spills.push(TaskPriority::IO, [this] { spill(); });
+    }
+
+    void TransformCache::spill() {
+        std::vector<Transform> failed{}; // Kept in memory, not tried again by this job
+        while (true) {
+            Transform transform{};
+            std::shared_ptr<const Buffer> buffer{};
+
+            {
+                std::lock_guard lock{ m_Mutex };
+
+                // Only entries that the published buffer doesn't view free memory when spilled
+                auto it = m_Cache.end();
+                for (auto candidate = m_Cache.begin(); candidate != m_Cache.end(); ++candidate) {
+                    if (candidate->second.spilled || candidate->second.buffer.use_count() != 1) continue;
+                    if (std::find(failed.begin(), failed.end(), candidate->first) != failed.end()) continue;
+                    if (it == m_Cache.end() || spillOrder(candidate->first) < spillOrder(it->first)) it = candidate;
+                }
+
+                if (m_Bytes <= m_Budget || it == m_Cache.end()) {
+                    m_Spilling = false;
+                    return;
+                }
+
+                transform = it->first;
+                buffer = it->second.buffer;
+            }
+
+            // Written without holding the lock, so the cache can be used in the meantime
+            auto written = Spill::write(*buffer);
+            auto mapped = written ? Spill::map(std::move(written)) : nullptr;
+
+            std::lock_guard lock{ m_Mutex };
+            auto it = m_Cache.find(transform);
+            if (it == m_Cache.end() || it->second.buffer != buffer) continue; // Cleared in the meantime
+
+            Entry& entry = it->second;
+            if (mapped) {
+                // Got published in the meantime, the mapping would only add to the memory
+                if (buffer.use_count() > 2) continue;
+
+                KAIXO_DEBUG("Spilled transform '{}' to disk.", transform);
+                entry.buffer = std::move(mapped);
+                entry.spilled = true;
+                m_Bytes -= bytesOf(*buffer);
+            } else if (transform != Transform::Identity) {
+                KAIXO_WARNING("Failed to spill transform '{}' to disk, dropping it, it can be recomputed from the identity.", transform);
+                m_Bytes -= bytesOf(*buffer);
+                m_Cache.erase(it);
+            } else {
+                KAIXO_ERROR("Failed to spill transform '{}' to disk, keeping it in memory.", transform);
+                failed.push_back(transform);
+            }
+        }
+    }
+
+    std::shared_ptr<const juce::AudioBuffer<float>> TransformCache::readBack(Transform t, std::shared_ptr<const Buffer> spilled) {
+        // Copied without holding the lock, reading a spilled buffer can page it in from disk
+        auto buffer = std::make_shared<const Buffer>(*spilled);
+
+        std::lock_guard lock{ m_Mutex };
+        auto it = m_Cache.find(t);
+        if (it == m_Cache.end() || it->second.buffer != spilled) return buffer; // Changed in the meantime
+
+        KAIXO_DEBUG("Read spilled transform '{}' back into memory.", t);
+        it->second.buffer = buffer;
+        it->second.spilled = false;
+        m_Bytes += bytesOf(*buffer);
+        spillOverBudget(); // Other entries make room, this one is in use
+        return buffer;
+    }
 
     // ------------------------------------------------
 
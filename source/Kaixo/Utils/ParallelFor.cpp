@@ -0,0 +1,75 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/ParallelFor.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo {
+
+    // ------------------------------------------------
+
+    void parallelFor(TaskPriority priority, std::size_t count, std::function<void(std::size_t)> task) {
+        if (count == 0) return;
+        if (count == 1) return task(0);
+
+        // ------------------------------------------------
+
+        // Shared with the helpers, which may only start after this call has already returned.
+        struct State {
+            std::function<void(std::size_t)> task;
+            std::size_t count;
+            std::atomic_size_t next = 0;
+            std::atomic_size_t done = 0;
+            std::mutex mutex{};
+            std::condition_variable finished{};
+            std::exception_ptr error{};
+        };
+
+        auto state = std::make_shared<State>(std::move(task), count);
+
+        // Helpers stop early when more urgent tasks are waiting, the calling thread does what they leave.
+        auto work = [state](TaskScheduler* helping, TaskPriority priority) {
+            while (true) {
+                if (helping && helping->preempted(priority)) return;
+
+                std::size_t index = state->next.fetch_add(1, std::memory_order_relaxed);
+                if (index >= state->count) return;
+
+                try {
+                    state->task(index);
+                } catch (...) {
+                    std::lock_guard lock{ state->mutex };
+                    if (!state->error) state->error = std::current_exception();
+                }
+
+                if (state->done.fetch_add(1, std::memory_order_acq_rel) + 1 == state->count) {
+                    std::lock_guard lock{ state->mutex };
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        // ------------------------------------------------
+
+        auto scheduler = TaskScheduler::shared();
+        std::size_t helpers = std::min(count - 1, scheduler->threads());
+        for (std::size_t i = 0; i < helpers; ++i) {
+            scheduler->post(priority, [work, helping = scheduler.get(), priority] { work(helping, priority); });
+        }
+
+        work(nullptr, priority);
+
+        // ------------------------------------------------
+
+        std::unique_lock lock{ state->mutex };
+        state->finished.wait(lock, [&] { return state->done.load(std::memory_order_acquire) == count; });
+
+        if (state->error) std::rethrow_exception(state->error);
+    }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------
@@ -0,0 +1,256 @@
+
+// ------------------------------------------------
+
+#include "Kaixo/Utils/TaskScheduler.hpp"
+
+// ------------------------------------------------
+
+namespace Kaixo {
+
+    // ------------------------------------------------
+
+    namespace {
+        // Set on the worker threads, so tasks posted from a worker go to its own queue.
+        thread_local const TaskScheduler* t_Scheduler = nullptr;
+        thread_local std::size_t t_Worker = 0;
+    }
+
+    // ------------------------------------------------
+
+    std::shared_ptr<TaskScheduler> TaskScheduler::shared() {
+        static std::mutex mutex{};
+        static std::weak_ptr<TaskScheduler> scheduler{};
+
+        std::lock_guard lock{ mutex };
+        auto result = scheduler.lock();
+        if (!result) {
+            result = std::make_shared<TaskScheduler>(std::max(std::thread::hardware_concurrency(), 2u));
+            scheduler = result;
+        }
+
+        return result;
+    }
+
+    // ------------------------------------------------
+
+    TaskScheduler::TaskScheduler(std::size_t threads) {
+        for (std::size_t i = 0; i < threads; ++i) {
+            m_Workers.push_back(std::make_unique<Worker>());
+        }
+
+        for (std::size_t i = 0; i < threads; ++i) {
+            m_Threads.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    TaskScheduler::~TaskScheduler() {
+        {
+            std::lock_guard lock{ m_Mutex };
+            m_Stop = true;
+        }
+
+        m_Wake.notify_all();
+        for (auto& thread : m_Threads) thread.join();
+    }
+
+    // ------------------------------------------------
+
+    void TaskScheduler::post(TaskPriority priority, Task task) {
+        const std::size_t index = static_cast<std::size_t>(priority);
+
+        {
+            // The pending count is updated together with the push, so a worker
+            // never takes a task before it has been counted.
+            std::lock_guard lock{ m_Mutex };
+            if (t_Scheduler == this) {
+                auto& worker = *m_Workers[t_Worker];
+                std::lock_guard workerLock{ worker.mutex };
+                worker.tasks[index].push_back(std::move(task));
+            } else {
+                m_Tasks[index].push_back(std::move(task));
+            }
+
+            ++m_Pending;
+            m_Waiting[index].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        m_Wake.notify_one();
+    }
+
+    bool TaskScheduler::preempted(TaskPriority priority) const {
+        for (std::size_t index = 0; index < static_cast<std::size_t>(priority); ++index) {
+            if (m_Waiting[index].load(std::memory_order_relaxed) > 0) return true;
+        }
+
+        return false;
+    }
+
+    // ------------------------------------------------
+
+    void TaskScheduler::run(std::size_t worker) {
+        t_Scheduler = this;
+        t_Worker = worker;
+
+        while (true) {
+            Task task;
+            if (take(worker, task)) {
+                task();
+                continue;
+            }
+
+            std::unique_lock lock{ m_Mutex };
+            m_Wake.wait(lock, [&] { return m_Stop || m_Pending > 0; });
+            if (m_Stop && m_Pending == 0) return; // Queued tasks are finished first
+        }
+    }
+
+    bool TaskScheduler::take(std::size_t worker, Task& task) {
+        auto taken = [&](std::size_t priority) {
+            std::lock_guard lock{ m_Mutex };
+            --m_Pending;
+            m_Waiting[priority].fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        };
+
+        for (std::size_t priority = 0; priority < Priorities; ++priority) {
+            // Newest task of its own, most likely still in cache
+            {
+                auto& own = *m_Workers[worker];
+                std::lock_guard lock{ own.mutex };
+                if (!own.tasks[priority].empty()) {
+                    task = std::move(own.tasks[priority].back());
+                    own.tasks[priority].pop_back();
+                }
+            }
+
+            if (task) return taken(priority);
+
+            // Tasks posted from outside the workers
+            {
+                std::lock_guard lock{ m_Mutex };
+                if (!m_Tasks[priority].empty()) {
+                    task = std::move(m_Tasks[priority].front());
+                    m_Tasks[priority].pop_front();
+                    --m_Pending;
+                    m_Waiting[priority].fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+
+            // Oldest task of another worker
+            for (std::size_t i = 1; i < m_Workers.size(); ++i) {
+                auto& other = *m_Workers[(worker + i) % m_Workers.size()];
+                {
+                    std::lock_guard lock{ other.mutex };
+                    if (!other.tasks[priority].empty()) {
+                        task = std::move(other.tasks[priority].front());
+                        other.tasks[priority].pop_front();
+                    }
+                }
+
+                if (task) return taken(priority);
+            }
+        }
+
+        return false;
+    }
+
+    // ------------------------------------------------
+
+    TaskScheduler::Lane::Lane(std::shared_ptr<TaskScheduler> scheduler)
+        : m_Scheduler(std::move(scheduler))
+    {}
+
+    TaskScheduler::Lane::~Lane() {
+        std::unique_lock lock{ m_Mutex };
+        m_Tasks.clear();
+        m_Idle.wait(lock, [&] { return !m_Running; });
+    }
+
+    // ------------------------------------------------
+
+    void TaskScheduler::Lane::post(TaskPriority priority, Task task) {
+        std::lock_guard lock{ m_Mutex };
+        m_Tasks.push_back({ priority, std::move(task) });
+        if (!m_Running) {
+            m_Running = true;
+            m_Scheduler->post(priority, [this] { runNext(); });
+        }
+    }
+
+    void TaskScheduler::Lane::runNext() {
+        Task task;
+        {
+            std::lock_guard lock{ m_Mutex };
+            if (!m_Tasks.empty()) {
+                task = std::move(m_Tasks.front().task);
+                m_Tasks.pop_front();
+            }
+        }
+
+        if (task) task();
+
+        // Only one task of the lane is ever scheduled, the next one is
+        // scheduled once this one is done, at its own priority.
+        std::lock_guard lock{ m_Mutex };
+        if (m_Tasks.empty()) {
+            m_Running = false;
+            m_Idle.notify_all();
+        } else {
+            m_Scheduler->post(m_Tasks.front().priority, [this] { runNext(); });
+        }
+    }
+
+    // ------------------------------------------------
+
+    TaskScheduler::ReadWriteLane::ReadWriteLane(std::shared_ptr<TaskScheduler> scheduler)
+        : m_Scheduler(std::move(scheduler))
+    {}
+
+    TaskScheduler::ReadWriteLane::~ReadWriteLane() {
+        std::unique_lock lock{ m_Mutex };
+        m_Tasks.clear();
+        m_Idle.wait(lock, [&] { return !m_Writing && m_Reading == 0; });
+    }
+
+    // ------------------------------------------------
+
+    void TaskScheduler::ReadWriteLane::post(TaskAccess access, TaskPriority priority, Task task) {
+        std::lock_guard lock{ m_Mutex };
+        m_Tasks.push_back({ access, priority, std::move(task) });
+        schedule();
+    }
+
+    void TaskScheduler::ReadWriteLane::finish(TaskAccess access) {
+        std::lock_guard lock{ m_Mutex };
+        if (access == TaskAccess::Write) m_Writing = false;
+        else --m_Reading;
+
+        schedule();
+
+        if (!m_Writing && m_Reading == 0) m_Idle.notify_all();
+    }
+
+    void TaskScheduler::ReadWriteLane::schedule() {
+        // Tasks start in order, so a read never overtakes a write that was pushed before it.
+        while (!m_Tasks.empty() && !m_Writing) {
+            if (m_Tasks.front().access == TaskAccess::Write && m_Reading > 0) return;
+
+            Entry entry = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+
+            if (entry.access == TaskAccess::Write) m_Writing = true;
+            else ++m_Reading;
+
+            m_Scheduler->post(entry.priority, [this, access = entry.access, task = std::move(entry.task)] {
+                task();
+                finish(access);
+            });
+        }
+    }
+
+    // ------------------------------------------------
+
+}
+
+// ------------------------------------------------